@@ -7,23 +7,7 @@
 namespace color {
 
     std::string getColorConstant(int index) {
-        switch (index) {
-            case 7:
-            case 6:
-                return color::RED;
-            case 5:
-                return color::YELLOW;
-            case 4:
-                return color::GREEN;
-            case 3:
-                return color::BLUE;
-            case 2:
-                return color::CYAN;
-            case 1:
-                return color::MAGENTA;
-            default:
-                return "";
-        }
+        return std::string(scale(index));
     }
 
-} // color
\ No newline at end of file
+} // color
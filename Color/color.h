@@ -5,11 +5,14 @@
 #ifndef MATRIX_COLOR_H
 #define MATRIX_COLOR_H
 
+#include <array>
 #include <iostream>
+#include <string>
+#include <string_view>
 
 namespace color {
 
-    const std::string
+    inline constexpr std::string_view
             GREEN = "\033[1;92m",
             RED = "\033[1;31m",
             CYAN = "\033[1;96m",
@@ -24,6 +27,19 @@ namespace color {
             BLUE_BACKGROUND = "\033[44;97m",
             RESET = "\033[0m";
 
+    // Color of each level of the scale: White < Magenta < Cyan < Blue < Green < Yellow < Red
+    inline constexpr std::array<std::string_view, 8> SCALE{"", MAGENTA, CYAN, BLUE, GREEN, YELLOW, RED, RED};
+
+    /**
+     * @brief Color of level index of the scale, without allocating.
+     *
+     * @param index Level, from 0 (no color) to 7 (red).
+     * @return The escape sequence of the level, empty if index is out of range.
+     */
+    constexpr std::string_view scale(int index) {
+        return (index >= 0 && index < static_cast<int>(SCALE.size())) ? SCALE[index] : std::string_view();
+    }
+
     [[maybe_unused]] std::string getColorConstant(int index);
 
 
@@ -5,7 +5,7 @@
 #ifndef MATRIX_TENSOR_ERROR_PROGRAMING_H
 #define MATRIX_TENSOR_ERROR_PROGRAMING_H
 
-#include "../tensor.h"
+#include <string>
 #include <stdexcept>
 
 namespace tns {
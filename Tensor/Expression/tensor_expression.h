@@ -0,0 +1,802 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_TENSOR_EXPRESSION_H
+#define MATRIX_TENSOR_EXPRESSION_H
+
+/**
+ * @file tensor_expression.h
+ * @brief Lazy expression templates for the element-wise arithmetic of tns::tensor.
+ *
+ * @details
+ * `+ - /`, `multiply()`, the scalar operators, `^` and `elementWise()` do not compute anything: they return a small
+ * expression node describing the operation. A whole chain such as `(w * x + b).elementWise(ReLU) * 0.5` is
+ * evaluated in one pass straight into the destination buffer, when it is assigned to a tensor or when eval() is
+ * called. Matrix multiplication (`tensor * tensor`) is not element-wise and is always evaluated right away.
+ *
+ * Tensors passed as lvalues are referenced, so they must outlive the expression. Temporary tensors (for example
+ * the result of `w * x`) are moved into the expression, so `auto e = w * x + b;` is safe to keep.
+ *
+ * Array operands must have the same shape() (see View/tensor_shape.h), or shapes that broadcast like in NumPy
+ * (see broadcastShape()): `w * x + b` adds a (n x 1) bias to every column of a (n x m) product. A broadcast operand is
+ * never tiled, its repeated dimensions are read with stride 0 (see expr::broadcast_index). Evaluation works on the
+ * matrix form (row(), col()): tensors are contiguous, so the element-wise kernels see one flat array whatever
+ * their rank, and trees that broadcast are evaluated row by row, each row with one SIMD kernel call.
+ *
+ * A tensor_view (column, row, slice, transpose or permutation, see View/tensor_view.h) is itself an expression.
+ * Trees holding one are strided (is_strided): they are evaluated row by row through at(i, j), with the SIMD kernels
+ * on rows whose elements are contiguous (rowData()).
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+
+#include "../Exception/tensor_error_programing.h"
+#include "../Kernel/elementwise.h"
+#include "../Kernel/simd.h"
+#include "../View/tensor_shape.h"
+
+namespace tns {
+
+    template<typename type>
+    class tensor;
+
+    template<typename type>
+    class tensor_view;
+
+    /**
+     * @brief Base of every expression node (CRTP).
+     *
+     * @tparam Derived The expression node type.
+     */
+    template<typename Derived>
+    struct expression {
+        [[nodiscard]] const Derived &self() const { return static_cast<const Derived &>(*this); }
+
+        /**
+         * @brief Evaluate the expression into a NEW tensor.
+         */
+        [[nodiscard]] auto eval() const { return tensor<typename Derived::value_type>(self()); }
+
+        /**
+         * @brief Lazily apply a unary function to each element of the expression.
+         */
+        template<typename Function>
+        auto elementWise(Function func) const &;
+
+        template<typename Function>
+        auto elementWise(Function func) &&;
+
+        /**
+         * @brief Lazy Hadamard product with a tensor or an expression of the same shape, or one that broadcasts.
+         */
+        template<typename Rhs>
+        auto multiply(Rhs &&rhs) const &;
+
+        template<typename Rhs>
+        auto multiply(Rhs &&rhs) &&;
+    };
+
+    template<typename T>
+    constexpr bool is_expression_v = std::is_base_of_v<expression<std::remove_cvref_t<T>>, std::remove_cvref_t<T>>;
+
+    namespace expr {
+
+        template<typename T>
+        struct is_tensor : std::false_type {
+        };
+
+        template<typename T>
+        struct is_tensor<tensor<T>> : std::true_type {
+        };
+
+        template<typename T>
+        constexpr bool is_tensor_v = is_tensor<std::remove_cvref_t<T>>::value;
+
+        template<typename T>
+        struct is_view : std::false_type {
+        };
+
+        template<typename T>
+        struct is_view<tensor_view<T>> : std::true_type {
+        };
+
+        template<typename T>
+        constexpr bool is_view_v = is_view<std::remove_cvref_t<T>>::value;
+
+        // Tensor or view, i.e. elements in memory described by a pointer and two strides
+        template<typename T>
+        constexpr bool is_matrix_v = is_tensor_v<T> || is_view_v<T>;
+
+        // Tensor or expression, i.e. something with a shape
+        template<typename T>
+        constexpr bool is_array_v = is_tensor_v<T> || is_expression_v<T>;
+
+        template<typename T>
+        constexpr bool is_scalar_v = std::is_arithmetic_v<std::remove_cvref_t<T>>;
+
+        template<typename T>
+        constexpr bool is_operand_v = is_array_v<T> || is_scalar_v<T>;
+
+        // Element type of a tensor or an expression
+        template<typename T, typename = void>
+        struct value_of {
+            using type = void;
+        };
+
+        template<typename T>
+        struct value_of<tensor<T>> {
+            using type = T;
+        };
+
+        template<typename T>
+        struct value_of<T, std::enable_if_t<is_expression_v<T>>> {
+            using type = typename T::value_type;
+        };
+
+        template<typename T>
+        using value_of_t = typename value_of<std::remove_cvref_t<T>>::type;
+
+        // Element type of a binary operation: the element type of its array operand(s)
+        template<typename L, typename R>
+        using result_value_t = std::conditional_t<is_array_v<L>, value_of_t<L>, value_of_t<R>>;
+
+        // Element-wise operations. name is used in the shape mismatch message, binaryKernel and scalarKernel (when
+        // present) select the SIMD kernel used for `tensor op tensor` and `tensor op scalar`.
+        struct add_op {
+            static constexpr const char *name = "+ element-wise addition";
+
+            template<typename T>
+            static constexpr auto binaryKernel = &simd::kernel_table<T>::add;
+
+            template<typename T>
+            static constexpr auto scalarKernel = &simd::kernel_table<T>::addScalar;
+
+            template<typename T>
+            T operator()(T a, T b) const { return a + b; }
+        };
+
+        struct sub_op {
+            static constexpr const char *name = "- element-wise subtraction";
+
+            template<typename T>
+            static constexpr auto binaryKernel = &simd::kernel_table<T>::sub;
+
+            template<typename T>
+            static constexpr auto scalarKernel = &simd::kernel_table<T>::subScalar;
+
+            template<typename T>
+            T operator()(T a, T b) const { return a - b; }
+        };
+
+        struct mul_op {
+            static constexpr const char *name = "^ element-wise production";
+
+            template<typename T>
+            static constexpr auto binaryKernel = &simd::kernel_table<T>::mul;
+
+            template<typename T>
+            static constexpr auto scalarKernel = &simd::kernel_table<T>::mulScalar;
+
+            template<typename T>
+            T operator()(T a, T b) const { return a * b; }
+        };
+
+        struct div_op {
+            static constexpr const char *name = "/ element-wise division";
+
+            template<typename T>
+            static constexpr auto binaryKernel = &simd::kernel_table<T>::div;
+
+            template<typename T>
+            static constexpr auto scalarKernel = &simd::kernel_table<T>::divScalar;
+
+            template<typename T>
+            T operator()(T a, T b) const { return a / b; }
+        };
+
+        struct pow_op {
+            static constexpr const char *name = "^ element-wise power";
+
+            template<typename T>
+            T operator()(T a, T b) const { return static_cast<T>(std::pow(a, b)); }
+        };
+
+        // Node reading straight from a tensor buffer, element k at data()[k]
+        template<typename N>
+        concept dense_node = !N::is_strided && requires(const N &node) {
+            { node.data() } -> std::convertible_to<const typename N::value_type *>;
+        };
+
+        // Node whose row i starts at rowData(i), or nullptr when the elements of a row are not contiguous
+        template<typename N>
+        concept row_node = requires(const N &node) {
+            { node.rowData(size_t()) } -> std::convertible_to<const typename N::value_type *>;
+        };
+
+        /**
+         * @brief Where the elements of a broadcast operand are: element (i, j) of the result is element
+         * row(i) + j * colStep of the operand, in its row-major order. Dimensions the operand repeats have stride 0,
+         * so a bias row or column is read in place, never tiled.
+         */
+        struct broadcast_index {
+            bool identity;  // The operand has the shape of the result
+            size_t colStep; // 1, or 0 when the operand repeats its last element along each row
+            size_t rank;    // Leading dimensions of the result, collapsed (see kernel::collapseDims())
+            size_t dims[tensor_shape::max_rank];
+            size_t strides[tensor_shape::max_rank];
+
+            broadcast_index() = default;
+
+            broadcast_index(const tensor_shape &operand, const tensor_shape &result) : identity(operand == result) {
+                const size_t resultRank = result.rank(), pad = resultRank - operand.rank();
+                size_t steps[tensor_shape::max_rank];
+                for (size_t axis = resultRank, stride = 1; axis-- > 0;) {
+                    const size_t dim = (axis < pad) ? 1 : operand[axis - pad];
+                    steps[axis] = (dim == 1) ? 0 : stride;
+                    stride *= dim;
+                }
+
+                // The only dimension of a (n) result indexes the rows of its (n x 1) matrix form
+                const size_t leading = (resultRank <= 1) ? resultRank : resultRank - 1;
+                colStep = (resultRank <= 1) ? 0 : steps[resultRank - 1];
+                std::copy_n(result.begin(), leading, dims);
+                std::copy_n(steps, leading, strides);
+                rank = kernel::collapseDims(leading, dims, strides);
+            }
+
+            // Index, in the operand, of the first element of row i of the result
+            [[nodiscard]] size_t row(size_t i) const {
+                if (rank <= 1) {
+                    return rank == 0 ? 0 : i * strides[0];
+                }
+                size_t offset = 0;
+                for (size_t k = rank; k-- > 0;) {
+                    offset += (i % dims[k]) * strides[k];
+                    i /= dims[k];
+                }
+                return offset;
+            }
+        };
+
+        /**
+         * @brief Reference to a tensor that outlives the expression.
+         */
+        template<typename T>
+        struct leaf : expression<leaf<T>> {
+            using value_type = T;
+            static constexpr bool is_scalar = false;
+
+            const tensor<T> *source;
+            const T *ptr;
+
+            static constexpr bool is_strided = false;
+
+            explicit leaf(const tensor<T> &source) : source(&source), ptr(source.data().data()) {}
+
+            [[nodiscard]] size_t row() const { return source->row(); }
+
+            [[nodiscard]] size_t col() const { return source->col(); }
+
+            [[nodiscard]] const tensor_shape &shape() const { return source->shape(); }
+
+            [[nodiscard]] const T *data() const { return ptr; }
+
+            [[nodiscard]] const T *rowData(size_t i) const { return ptr + i * source->col(); }
+
+            // Element (i, j) is only written after being read, so a leaf of the destination is safe
+            [[nodiscard]] bool overlaps(const T * /*first*/, const T * /*last*/) const { return false; }
+
+            [[nodiscard]] static constexpr bool broadcasting() { return false; }
+
+            T operator[](size_t k) const { return ptr[k]; }
+
+            T at(size_t i, size_t j) const { return ptr[i * source->col() + j]; }
+        };
+
+        /**
+         * @brief Temporary tensor moved into the expression.
+         */
+        template<typename T>
+        struct owned : expression<owned<T>> {
+            using value_type = T;
+            static constexpr bool is_scalar = false;
+
+            tensor<T> source;
+            const T *ptr;
+
+            explicit owned(tensor<T> &&source) : source(std::move(source)), ptr(this->source.data().data()) {}
+
+            owned(const owned &other) : source(other.source), ptr(source.data().data()) {}
+
+            owned(owned &&other) noexcept : source(std::move(other.source)), ptr(source.data().data()) {}
+
+            static constexpr bool is_strided = false;
+
+            [[nodiscard]] size_t row() const { return source.row(); }
+
+            [[nodiscard]] size_t col() const { return source.col(); }
+
+            [[nodiscard]] const tensor_shape &shape() const { return source.shape(); }
+
+            [[nodiscard]] const T *data() const { return ptr; }
+
+            [[nodiscard]] const T *rowData(size_t i) const { return ptr + i * source.col(); }
+
+            [[nodiscard]] bool overlaps(const T * /*first*/, const T * /*last*/) const { return false; }
+
+            [[nodiscard]] static constexpr bool broadcasting() { return false; }
+
+            T operator[](size_t k) const { return ptr[k]; }
+
+            T at(size_t i, size_t j) const { return ptr[i * source.col() + j]; }
+        };
+
+        /**
+         * @brief Scalar operand, the same value for every element.
+         */
+        template<typename T>
+        struct constant {
+            using value_type = T;
+            static constexpr bool is_scalar = true;
+
+            static constexpr bool is_strided = false;
+
+            T value;
+
+            [[nodiscard]] bool overlaps(const T * /*first*/, const T * /*last*/) const { return false; }
+
+            [[nodiscard]] static constexpr bool broadcasting() { return false; }
+
+            T operator[](size_t /*k*/) const { return value; }
+
+            T at(size_t /*i*/, size_t /*j*/) const { return value; }
+        };
+
+        /**
+         * @brief Element-wise binary operation lhs[k] op rhs[k], broadcasting operands of different shapes.
+         */
+        template<typename L, typename R, typename Op>
+        struct binary : expression<binary<L, R, Op>> {
+            using value_type = typename L::value_type;
+            using lhs_type = L;
+            using rhs_type = R;
+            using op_type = Op;
+            static constexpr bool is_scalar = false;
+            static constexpr bool is_strided = L::is_strided || R::is_strided;
+
+            L lhs;
+            R rhs;
+
+            // Set when the array operands have different shapes, see broadcastShape()
+            bool broadcast{};
+            tensor_shape resultShape;
+            broadcast_index lhsIndex, rhsIndex;
+
+            binary(L lhs, R rhs) : lhs(std::move(lhs)), rhs(std::move(rhs)) {
+                if constexpr (!L::is_scalar && !R::is_scalar) {
+                    const tensor_shape &lhsShape = this->lhs.shape(), &rhsShape = this->rhs.shape();
+                    if (lhsShape != rhsShape) {
+                        if (!broadcastShape(lhsShape, rhsShape, resultShape)) {
+                            std::ostringstream message;
+                            message << "\nMatrix shape mismatch (" << Op::name << "): " << lhsShape << " vs "
+                                    << rhsShape;
+                            throw ShapeMismatchException(message.str(), this->lhs.row(), this->lhs.col(),
+                                                         this->rhs.row(), this->rhs.col());
+                        }
+                        broadcast = true;
+                        lhsIndex = broadcast_index(lhsShape, resultShape);
+                        rhsIndex = broadcast_index(rhsShape, resultShape);
+                    }
+                }
+            }
+
+            [[nodiscard]] size_t row() const {
+                if constexpr (L::is_scalar) {
+                    return rhs.row();
+                } else {
+                    return broadcast ? resultShape.rows() : lhs.row();
+                }
+            }
+
+            [[nodiscard]] size_t col() const {
+                if constexpr (L::is_scalar) {
+                    return rhs.col();
+                } else {
+                    return broadcast ? resultShape.cols() : lhs.col();
+                }
+            }
+
+            [[nodiscard]] const tensor_shape &shape() const {
+                if constexpr (L::is_scalar) {
+                    return rhs.shape();
+                } else {
+                    return broadcast ? resultShape : lhs.shape();
+                }
+            }
+
+            // Whether this node or one below broadcasts, so elements cannot be read by their linear index alone
+            [[nodiscard]] bool broadcasting() const {
+                return broadcast || lhs.broadcasting() || rhs.broadcasting();
+            }
+
+            [[nodiscard]] bool overlaps(const value_type *first, const value_type *last) const {
+                return lhs.overlaps(first, last) || rhs.overlaps(first, last);
+            }
+
+            value_type operator[](size_t k) const {
+                if (broadcast) {
+                    return at(k / col(), k % col());
+                }
+                return Op()(lhs[k], rhs[k]);
+            }
+
+            value_type at(size_t i, size_t j) const {
+                return Op()(operandAt(lhs, lhsIndex, i, j), operandAt(rhs, rhsIndex, i, j));
+            }
+
+            // Row i of an operand as contiguous elements, or nullptr (also when the operand repeats one element)
+            [[nodiscard]] const value_type *lhsRow(size_t i) const { return operandRow(lhs, lhsIndex, i); }
+
+            [[nodiscard]] const value_type *rhsRow(size_t i) const { return operandRow(rhs, rhsIndex, i); }
+
+        private:
+            template<typename N>
+            value_type operandAt(const N &node, const broadcast_index &index, size_t i, size_t j) const {
+                if constexpr (N::is_scalar) {
+                    return node.value;
+                } else {
+                    if (broadcast && !index.identity) {
+                        return node[index.row(i) + j * index.colStep];
+                    }
+                    return node.at(i, j);
+                }
+            }
+
+            template<typename N>
+            const value_type *operandRow(const N &node, const broadcast_index &index, size_t i) const {
+                if constexpr (N::is_scalar) {
+                    return nullptr;
+                } else if constexpr (dense_node<N>) {
+                    if (!broadcast || index.identity) {
+                        return node.data() + i * col();
+                    }
+                    return index.colStep == 1 ? node.data() + index.row(i) : nullptr;
+                } else if constexpr (row_node<N>) {
+                    if (!broadcast || index.identity) {
+                        return node.rowData(i);
+                    }
+                    // Rows of the operand start at multiples of its width when it is also the width of the result
+                    return (index.colStep == 1 && node.col() == col()) ? node.rowData(index.row(i) / col()) : nullptr;
+                } else {
+                    return nullptr;
+                }
+            }
+        };
+
+        /**
+         * @brief Element-wise unary function func(arg[k]), converted back to the element type.
+         */
+        template<typename E, typename Function>
+        struct map : expression<map<E, Function>> {
+            using value_type = typename E::value_type;
+            using arg_type = E;
+            using function_type = Function;
+            static constexpr bool is_scalar = false;
+            static constexpr bool is_strided = E::is_strided;
+
+            E arg;
+            Function func;
+
+            map(E arg, Function func) : arg(std::move(arg)), func(std::move(func)) {}
+
+            [[nodiscard]] size_t row() const { return arg.row(); }
+
+            [[nodiscard]] size_t col() const { return arg.col(); }
+
+            [[nodiscard]] const tensor_shape &shape() const { return arg.shape(); }
+
+            [[nodiscard]] bool broadcasting() const { return arg.broadcasting(); }
+
+            [[nodiscard]] bool overlaps(const value_type *first, const value_type *last) const {
+                return arg.overlaps(first, last);
+            }
+
+            value_type operator[](size_t k) const { return static_cast<value_type>(func(arg[k])); }
+
+            value_type at(size_t i, size_t j) const { return static_cast<value_type>(func(arg.at(i, j))); }
+        };
+
+        /**
+         * @brief Turn an operand into an expression node: lvalue tensors are referenced, temporary tensors are
+         * moved in, expressions are copied (or moved) and scalars are converted to T.
+         */
+        template<typename T, typename Operand>
+        auto wrap(Operand &&operand) {
+            using Raw = std::remove_cvref_t<Operand>;
+            if constexpr (is_tensor_v<Raw>) {
+                static_assert(std::is_same_v<value_of_t<Raw>, T>, "Element types of the operands must match");
+                if constexpr (std::is_lvalue_reference_v<Operand>) {
+                    return leaf<T>(operand);
+                } else {
+                    return owned<T>(std::move(operand));
+                }
+            } else if constexpr (is_expression_v<Raw>) {
+                static_assert(std::is_same_v<value_of_t<Raw>, T>, "Element types of the operands must match");
+                return Raw(std::forward<Operand>(operand));
+            } else {
+                return constant<T>{static_cast<T>(operand)};
+            }
+        }
+
+        template<typename Op, typename L, typename R>
+        auto makeBinary(L &&lhs, R &&rhs) {
+            using T = result_value_t<L, R>;
+            auto lhsNode = wrap<T>(std::forward<L>(lhs));
+            auto rhsNode = wrap<T>(std::forward<R>(rhs));
+            return binary<decltype(lhsNode), decltype(rhsNode), Op>(std::move(lhsNode), std::move(rhsNode));
+        }
+
+        // Element-wise operator: both sides are operands, at least one has a shape
+        template<typename L, typename R>
+        concept elementwise_operands = is_operand_v<L> && is_operand_v<R> && (is_array_v<L> || is_array_v<R>);
+
+        // Scaling: exactly one side is a scalar (tensor * tensor is the matrix multiplication)
+        template<typename L, typename R>
+        concept scaling_operands = elementwise_operands<L, R> && (is_scalar_v<L> || is_scalar_v<R>);
+
+        // Matrix multiplication of tensors and views, at least one of them a view, run on the strides without a copy
+        template<typename L, typename R>
+        concept strided_matmul_operands = is_matrix_v<L> && is_matrix_v<R> && (is_view_v<L> || is_view_v<R>);
+
+        // Matrix multiplication involving at least one expression, which is evaluated first
+        template<typename L, typename R>
+        concept matmul_operands = is_array_v<L> && is_array_v<R> && (is_expression_v<L> || is_expression_v<R>)
+                                  && !strided_matmul_operands<L, R>;
+
+        // tensor op tensor, with a SIMD kernel for op
+        template<typename E>
+        concept simd_binary = requires {
+            E::op_type::template binaryKernel<typename E::value_type>;
+        } && dense_node<typename E::lhs_type> && dense_node<typename E::rhs_type>;
+
+        // tensor op scalar, with a SIMD kernel for op
+        template<typename E>
+        concept simd_scalar = requires {
+            E::op_type::template scalarKernel<typename E::value_type>;
+        } && dense_node<typename E::lhs_type> && E::rhs_type::is_scalar;
+
+        // func(tensor), run by the element-wise engine straight on the buffer
+        template<typename E>
+        concept dense_map = requires { typename E::function_type; } && dense_node<typename E::arg_type>;
+
+        template<typename E>
+        void evaluateRow(const E &e, size_t i, size_t cols, typename E::value_type *out);
+
+        // Evaluate into out the row of operand node that row i of a binary reads, if it reads a whole row of it
+        template<typename N, typename T>
+        bool evaluateOperandRow(const N &node, bool broadcast, const broadcast_index &index, size_t i, size_t cols,
+                                T *out) {
+            if constexpr (N::is_scalar) {
+                return false;
+            } else {
+                if (!broadcast || index.identity) {
+                    evaluateRow(node, i, cols, out);
+                    return true;
+                }
+                if (index.colStep == 1 && node.col() == cols) {
+                    evaluateRow(node, index.row(i) / cols, cols, out);
+                    return true;
+                }
+                return false;
+            }
+        }
+
+        /**
+         * @brief out[j] = e.at(i, j) for j in [0, cols): row i of `a op b` where a or b is broadcast. A row vector
+         * repeated down the rows is contiguous, so the row is one call to the binary kernel; a column vector repeated
+         * along the rows is one value per row, so the row is one call to the scalar kernel. An operand that is itself
+         * an expression is evaluated into out first, and combined with the other operand in place.
+         */
+        template<typename E>
+        void evaluateBroadcastRow(const E &e, size_t i, size_t cols, typename E::value_type *out) {
+            using T = typename E::value_type;
+            const auto binaryKernel = simd::kernels<T>().*(E::op_type::template binaryKernel<T>);
+            const auto scalarKernel = simd::kernels<T>().*(E::op_type::template scalarKernel<T>);
+            const T *a = e.lhsRow(i), *b = e.rhsRow(i);
+            const bool lhsRepeated = e.broadcast && e.lhsIndex.colStep == 0;
+            const bool rhsRepeated = e.broadcast && e.rhsIndex.colStep == 0;
+
+            // The kernels read and write each element at the same index, so out may be one of their operands
+            if (a != nullptr && b != nullptr) {
+                binaryKernel(a, b, out, cols);
+                return;
+            }
+            if (a != nullptr && rhsRepeated) {
+                scalarKernel(a, e.rhs[e.rhsIndex.row(i)], out, cols);
+                return;
+            }
+
+            // Below, out is filled with one operand before the other is read: it must not be a row of the destination
+            auto apart = [&](const T *row) { return row + cols <= out || out + cols <= row; };
+            if (b != nullptr && apart(b)) {
+                if (lhsRepeated) {
+                    std::fill_n(out, cols, e.lhs[e.lhsIndex.row(i)]);
+                    binaryKernel(out, b, out, cols);
+                    return;
+                }
+                if (evaluateOperandRow(e.lhs, e.broadcast, e.lhsIndex, i, cols, out)) {
+                    binaryKernel(out, b, out, cols);
+                    return;
+                }
+            }
+            if (a != nullptr && apart(a) && evaluateOperandRow(e.rhs, e.broadcast, e.rhsIndex, i, cols, out)) {
+                binaryKernel(a, out, out, cols);
+                return;
+            }
+            if (a == nullptr && b == nullptr && rhsRepeated
+                && evaluateOperandRow(e.lhs, e.broadcast, e.lhsIndex, i, cols, out)) {
+                scalarKernel(out, e.rhs[e.rhsIndex.row(i)], out, cols);
+                return;
+            }
+
+            for (size_t j = 0; j < cols; ++j) {
+                out[j] = e.at(i, j);
+            }
+        }
+
+        /**
+         * @brief out[j] = e.at(i, j) for j in [0, cols): row i of a strided expression. On rows long enough to pay
+         * for the call, `a op b` and `a op scalar` use their SIMD kernel, and func(a) an inlined loop, when the rows
+         * of their operands are contiguous.
+         */
+        template<typename E>
+        void evaluateRow(const E &e, size_t i, size_t cols, typename E::value_type *out) {
+            using T = typename E::value_type;
+            if (cols < 16) {
+                for (size_t j = 0; j < cols; ++j) {
+                    out[j] = e.at(i, j);
+                }
+                return;
+            }
+
+            if constexpr (requires { E::op_type::template binaryKernel<T>; }) {
+                if (e.broadcasting()) {
+                    evaluateBroadcastRow(e, i, cols, out);
+                    return;
+                }
+                if constexpr (row_node<typename E::lhs_type> && row_node<typename E::rhs_type>) {
+                    const T *a = e.lhs.rowData(i), *b = e.rhs.rowData(i);
+                    if (a != nullptr && b != nullptr) {
+                        (simd::kernels<T>().*(E::op_type::template binaryKernel<T>))(a, b, out, cols);
+                        return;
+                    }
+                } else if constexpr (row_node<typename E::lhs_type> && E::rhs_type::is_scalar) {
+                    if (const T *a = e.lhs.rowData(i)) {
+                        (simd::kernels<T>().*(E::op_type::template scalarKernel<T>))(a, e.rhs.value, out, cols);
+                        return;
+                    }
+                }
+            } else if constexpr (requires { typename E::function_type; }) {
+                if constexpr (row_node<typename E::arg_type>) {
+                    if (const T *a = e.arg.rowData(i)) {
+                        for (size_t j = 0; j < cols; ++j) {
+                            out[j] = static_cast<T>(e.func(a[j]));
+                        }
+                        return;
+                    }
+                }
+            }
+
+            for (size_t j = 0; j < cols; ++j) {
+                out[j] = e.at(i, j);
+            }
+        }
+
+        template<typename Operand>
+        decltype(auto) materialize(Operand &&operand) {
+            if constexpr (is_expression_v<Operand>) {
+                return operand.eval();
+            } else {
+                return static_cast<const std::remove_cvref_t<Operand> &>(operand);
+            }
+        }
+
+    } // expr
+
+    template<typename Derived>
+    template<typename Function>
+    auto expression<Derived>::elementWise(Function func) const & {
+        return expr::map<Derived, Function>(self(), std::move(func));
+    }
+
+    template<typename Derived>
+    template<typename Function>
+    auto expression<Derived>::elementWise(Function func) && {
+        return expr::map<Derived, Function>(std::move(static_cast<Derived &>(*this)), std::move(func));
+    }
+
+    template<typename Derived>
+    template<typename Rhs>
+    auto expression<Derived>::multiply(Rhs &&rhs) const & {
+        return expr::makeBinary<expr::mul_op>(self(), std::forward<Rhs>(rhs));
+    }
+
+    template<typename Derived>
+    template<typename Rhs>
+    auto expression<Derived>::multiply(Rhs &&rhs) && {
+        return expr::makeBinary<expr::mul_op>(std::move(static_cast<Derived &>(*this)), std::forward<Rhs>(rhs));
+    }
+
+    /**
+     * @brief Element-wise addition of tensors, expressions and scalars.
+     *
+     * @return A lazy expression, evaluated on assignment to a tensor or by eval().
+     * @throws ShapeMismatchException If two array operands have shapes that do not broadcast.
+     */
+    template<typename L, typename R> requires expr::elementwise_operands<L, R>
+    auto operator+(L &&lhs, R &&rhs) {
+        return expr::makeBinary<expr::add_op>(std::forward<L>(lhs), std::forward<R>(rhs));
+    }
+
+    /**
+     * @brief Element-wise subtraction of tensors, expressions and scalars.
+     *
+     * @return A lazy expression, evaluated on assignment to a tensor or by eval().
+     * @throws ShapeMismatchException If two array operands have shapes that do not broadcast.
+     */
+    template<typename L, typename R> requires expr::elementwise_operands<L, R>
+    auto operator-(L &&lhs, R &&rhs) {
+        return expr::makeBinary<expr::sub_op>(std::forward<L>(lhs), std::forward<R>(rhs));
+    }
+
+    /**
+     * @brief Element-wise division of tensors, expressions and scalars.
+     *
+     * @return A lazy expression, evaluated on assignment to a tensor or by eval().
+     * @throws ShapeMismatchException If two array operands have shapes that do not broadcast.
+     */
+    template<typename L, typename R> requires expr::elementwise_operands<L, R>
+    auto operator/(L &&lhs, R &&rhs) {
+        return expr::makeBinary<expr::div_op>(std::forward<L>(lhs), std::forward<R>(rhs));
+    }
+
+    /**
+     * @brief Multiply each element of a tensor or an expression by a scalar value.
+     *
+     * @return A lazy expression, evaluated on assignment to a tensor or by eval().
+     */
+    template<typename L, typename R> requires expr::scaling_operands<L, R>
+    auto operator*(L &&lhs, R &&rhs) {
+        return expr::makeBinary<expr::mul_op>(std::forward<L>(lhs), std::forward<R>(rhs));
+    }
+
+    /**
+     * @brief Matrix multiplication where at least one side is an expression. The expression is evaluated first.
+     *
+     * @return The result of a NEW tensor.
+     */
+    template<typename L, typename R> requires expr::matmul_operands<L, R>
+    auto operator*(L &&lhs, R &&rhs) {
+        return expr::materialize(std::forward<L>(lhs)) * expr::materialize(std::forward<R>(rhs));
+    }
+
+    /**
+     * @brief Raise each element of a tensor or an expression to the power of a scalar value.
+     *
+     * @return A lazy expression, evaluated on assignment to a tensor or by eval().
+     */
+    template<typename L, typename R> requires expr::is_array_v<L> && expr::is_scalar_v<R>
+    auto operator^(L &&lhs, R &&rhs) {
+        return expr::makeBinary<expr::pow_op>(std::forward<L>(lhs), std::forward<R>(rhs));
+    }
+
+} // tns
+
+#endif //MATRIX_TENSOR_EXPRESSION_H
@@ -0,0 +1,350 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_FIXED_TENSOR_H
+#define MATRIX_FIXED_TENSOR_H
+
+/**
+ * @file fixed_tensor.h
+ * @brief Matrix whose shape is part of its type, for the small transforms and dense heads of model code.
+ *
+ * @details
+ * A fixed_tensor<type, R, C> keeps its R * C elements inline in row-major order. It never allocates and its shape is
+ * a constant expression. An operation between incompatible shapes, like adding a (2 x 3) to a (3 x 2), fails to
+ * compile instead of throwing ShapeMismatchException, so none of its operators checks a shape at run time. Loops of at
+ * most fixed::unroll_limit iterations are unrolled at compile time: a 3x3 product or determinant is straight-line
+ * code, and every operation is constexpr.
+ *
+ * It interoperates with tns::tensor:
+ * - fixed_tensor(const tensor &) copies a tensor whose shape is only known at run time, and checks it;
+ * - toTensor() copies it into a tensor;
+ * - view() passes its elements to the expressions of tns::tensor without copying them, e.g. `X + bias.view()`.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "../tensor.h"
+
+namespace tns {
+
+    namespace fixed {
+
+        /**
+         * @brief Largest number of iterations of a loop that is unrolled. Longer loops keep constant bounds and are
+         * left to the compiler.
+         */
+        constexpr size_t unroll_limit = 64;
+
+        // f(i) for i in [0, N), i being a std::integral_constant when the loop is unrolled
+        template<size_t N, typename Function>
+        constexpr void unroll(Function &&f) {
+            if constexpr (N <= unroll_limit) {
+                [&]<size_t... I>(std::index_sequence<I...>) {
+                    (f(std::integral_constant<size_t, I>{}), ...);
+                }(std::make_index_sequence<N>{});
+            } else {
+                for (size_t i = 0; i < N; ++i) {
+                    f(i);
+                }
+            }
+        }
+
+    } // fixed
+
+    /**
+     * @brief A (R x C) matrix of elements of type, stored inline, with its shape checked at compile time.
+     *
+     * @tparam type The type of elements stored in the tensor.
+     * @tparam R The number of rows.
+     * @tparam C The number of columns.
+     */
+    template<typename type, size_t R, size_t C>
+    class fixed_tensor {
+        static_assert(R > 0 && C > 0, "tns::fixed_tensor: dimensions must be positive");
+
+        // Integer matrices are factorized in double, like tns::tensor
+        using lu_type = std::conditional_t<std::is_integral_v<type>, double, type>;
+
+        std::array<type, R * C> _data{};
+
+    public:
+        using value_type = type;
+
+        // Constructor
+        /**
+         * @brief (R x C) tensor of zeros.
+         */
+        constexpr fixed_tensor() = default;
+
+        /**
+         * @brief (R x C) tensor filled with initData.
+         */
+        constexpr explicit fixed_tensor(type initData) {
+            _data.fill(initData);
+        }
+
+        /**
+         * @brief Tensor of the given elements in row-major order, e.g. `fixed_tensor<float, 2, 2>{1, 0, 0, 1}`.
+         * Giving more or fewer than R * C elements does not compile.
+         */
+        template<typename... Values>
+        requires (sizeof...(Values) == R * C && sizeof...(Values) > 1 && (std::is_arithmetic_v<Values> && ...))
+        constexpr fixed_tensor(Values... values) : _data{static_cast<type>(values)...} {}
+
+        /**
+         * @brief Copy of a tns::tensor, whose shape is only known at run time.
+         *
+         * @throws ShapeMismatchException If other is not a (R x C) matrix.
+         */
+        explicit fixed_tensor(const tensor<type> &other) {
+            if (other.row() != R || other.col() != C) {
+                std::ostringstream message;
+                message << "\nMatrix shape mismatch (tns::fixed_tensor): (" << other.row() << ", " << other.col()
+                        << ") into (" << R << ", " << C << ")";
+                throw ShapeMismatchException(message.str(), other.row(), other.col(), R, C);
+            }
+            std::copy_n(other.data().data(), R * C, _data.begin());
+        }
+
+        /**
+         * @brief The (R x R) identity matrix.
+         */
+        static constexpr fixed_tensor identity() {
+            static_assert(R == C, "Matrix shape mismatch (tns::fixed_tensor::identity): not a square matrix");
+            fixed_tensor result;
+            fixed::unroll<R>([&](auto i) { result._data[i * C + i] = 1; });
+            return result;
+        }
+
+        // Getter
+        static constexpr size_t row() { return R; }
+
+        static constexpr size_t col() { return C; }
+
+        static constexpr size_t size() { return R * C; }
+
+        static constexpr tensor_shape shape() { return tensor_shape::matrix(R, C); }
+
+        constexpr std::span<type, R * C> data() { return _data; }
+
+        constexpr std::span<const type, R * C> data() const { return _data; }
+
+        /**
+         * @brief Element (i, j), not checked: use get<i, j>() to check a constant position at compile time.
+         */
+        constexpr type &operator()(size_t i, size_t j) { return _data[i * C + j]; }
+
+        constexpr type operator()(size_t i, size_t j) const { return _data[i * C + j]; }
+
+        /**
+         * @brief Element (i, j), a position outside the matrix does not compile.
+         */
+        template<size_t i, size_t j>
+        constexpr type &get() {
+            static_assert(i < R && j < C, "Matrix out of range (tns::fixed_tensor::get)");
+            return _data[i * C + j];
+        }
+
+        template<size_t i, size_t j>
+        constexpr type get() const {
+            static_assert(i < R && j < C, "Matrix out of range (tns::fixed_tensor::get)");
+            return _data[i * C + j];
+        }
+
+        // Interoperability with tns::tensor
+        /**
+         * @brief Copy the elements into a tns::tensor of shape (R x C).
+         */
+        tensor<type> toTensor() const {
+            tensor<type> result(R, C);
+            std::copy(_data.begin(), _data.end(), result.data().data());
+            return result;
+        }
+
+        /**
+         * @brief View of the elements, an operand of the expressions of tns::tensor. It is valid while this tensor
+         * lives and is not moved, so it cannot be taken of a temporary.
+         */
+        tensor_view<type> view() const & { return tensor_view<type>(_data.data(), R, C, C, 1); }
+
+        tensor_view<type> view() const && = delete;
+
+        // Element-wise operators
+        template<size_t R2, size_t C2>
+        constexpr fixed_tensor &operator+=(const fixed_tensor<type, R2, C2> &rhs) {
+            static_assert(R == R2 && C == C2, "Matrix shape mismatch (tns::fixed_tensor +=)");
+            fixed::unroll<R * C>([&](auto k) { _data[k] += rhs.data()[k]; });
+            return *this;
+        }
+
+        template<size_t R2, size_t C2>
+        constexpr fixed_tensor &operator-=(const fixed_tensor<type, R2, C2> &rhs) {
+            static_assert(R == R2 && C == C2, "Matrix shape mismatch (tns::fixed_tensor -=)");
+            fixed::unroll<R * C>([&](auto k) { _data[k] -= rhs.data()[k]; });
+            return *this;
+        }
+
+        constexpr fixed_tensor &operator*=(type num) {
+            fixed::unroll<R * C>([&](auto k) { _data[k] *= num; });
+            return *this;
+        }
+
+        constexpr fixed_tensor &operator/=(type num) {
+            fixed::unroll<R * C>([&](auto k) { _data[k] /= num; });
+            return *this;
+        }
+
+        /**
+         * @brief Hadamard product with a tensor of the same shape.
+         */
+        template<size_t R2, size_t C2>
+        constexpr fixed_tensor multiply(const fixed_tensor<type, R2, C2> &rhs) const {
+            static_assert(R == R2 && C == C2, "Matrix shape mismatch (tns::fixed_tensor::multiply)");
+            fixed_tensor result;
+            fixed::unroll<R * C>([&](auto k) { result._data[k] = _data[k] * rhs.data()[k]; });
+            return result;
+        }
+
+        // Transpose
+        constexpr fixed_tensor<type, C, R> T() const {
+            fixed_tensor<type, C, R> result;
+            fixed::unroll<R * C>([&](auto k) { result(k % C, k / C) = _data[k]; });
+            return result;
+        }
+
+        // Determinate
+        /**
+         * @brief Determinant of the square matrix, with closed forms up to (3 x 3) and Gaussian elimination with
+         * partial pivoting beyond. Calling it on a matrix that is not square does not compile.
+         */
+        constexpr type det() const {
+            static_assert(R == C, "Matrix shape mismatch (tns::fixed_tensor::det): not a square matrix");
+            const auto &a = _data;
+            if constexpr (R == 1) {
+                return a[0];
+            } else if constexpr (R == 2) {
+                return a[0] * a[3] - a[1] * a[2];
+            } else if constexpr (R == 3) {
+                return a[0] * (a[4] * a[8] - a[5] * a[7])
+                       - a[1] * (a[3] * a[8] - a[5] * a[6])
+                       + a[2] * (a[3] * a[7] - a[4] * a[6]);
+            } else {
+                std::array<lu_type, R * C> lu{};
+                fixed::unroll<R * C>([&](auto k) { lu[k] = static_cast<lu_type>(a[k]); });
+
+                lu_type result = 1;
+                for (size_t k = 0; k < R; ++k) {
+                    size_t pivot = k;
+                    for (size_t i = k + 1; i < R; ++i) {
+                        const lu_type candidate = lu[i * C + k], best = lu[pivot * C + k];
+                        pivot = ((candidate < 0 ? -candidate : candidate) > (best < 0 ? -best : best)) ? i : pivot;
+                    }
+                    if (lu[pivot * C + k] == lu_type(0)) {
+                        return 0;
+                    }
+                    if (pivot != k) {
+                        fixed::unroll<C>([&](auto j) { std::swap(lu[k * C + j], lu[pivot * C + j]); });
+                        result = -result;
+                    }
+
+                    result *= lu[k * C + k];
+                    for (size_t i = k + 1; i < R; ++i) {
+                        const lu_type factor = lu[i * C + k] / lu[k * C + k];
+                        fixed::unroll<C>([&](auto j) { lu[i * C + j] -= factor * lu[k * C + j]; });
+                    }
+                }
+                if constexpr (std::is_integral_v<type>) {
+                    return static_cast<type>(result < 0 ? result - 0.5 : result + 0.5);
+                } else {
+                    return result;
+                }
+            }
+        }
+
+        // Print the tensor
+        /**
+         * @brief Print a colorful representation of the tensor, like tensor::display().
+         */
+        void display(int precision = 2, bool color = true) const {
+            const auto [min, max] = std::minmax_element(_data.begin(), _data.end());
+            io::printTensor(std::cout, _data.data(), R, C, C, 1, *min, *max, precision, color);
+        }
+
+        friend constexpr bool operator==(const fixed_tensor &lhs, const fixed_tensor &rhs) = default;
+    };
+
+    // Element-wise operators
+    template<typename type, size_t R, size_t C, size_t R2, size_t C2>
+    constexpr fixed_tensor<type, R, C> operator+(fixed_tensor<type, R, C> lhs, const fixed_tensor<type, R2, C2> &rhs) {
+        static_assert(R == R2 && C == C2, "Matrix shape mismatch (tns::fixed_tensor +)");
+        return lhs += rhs;
+    }
+
+    template<typename type, size_t R, size_t C, size_t R2, size_t C2>
+    constexpr fixed_tensor<type, R, C> operator-(fixed_tensor<type, R, C> lhs, const fixed_tensor<type, R2, C2> &rhs) {
+        static_assert(R == R2 && C == C2, "Matrix shape mismatch (tns::fixed_tensor -)");
+        return lhs -= rhs;
+    }
+
+    template<typename type, size_t R, size_t C>
+    constexpr fixed_tensor<type, R, C> operator*(fixed_tensor<type, R, C> lhs, std::type_identity_t<type> num) {
+        return lhs *= num;
+    }
+
+    template<typename type, size_t R, size_t C>
+    constexpr fixed_tensor<type, R, C> operator*(std::type_identity_t<type> num, fixed_tensor<type, R, C> rhs) {
+        return rhs *= num;
+    }
+
+    template<typename type, size_t R, size_t C>
+    constexpr fixed_tensor<type, R, C> operator/(fixed_tensor<type, R, C> lhs, std::type_identity_t<type> num) {
+        return lhs /= num;
+    }
+
+    // Matrix multiplication
+    /**
+     * @brief Product of a (R x K) and a (K x C) matrix. Inner dimensions that differ do not compile. Up to
+     * fixed::unroll_limit multiply-adds the three loops are unrolled; beyond, the i-k-j loops keep constant bounds so
+     * the innermost one is vectorized.
+     */
+    template<typename type, size_t R, size_t K, size_t K2, size_t C>
+    constexpr fixed_tensor<type, R, C> operator*(const fixed_tensor<type, R, K> &lhs,
+                                                 const fixed_tensor<type, K2, C> &rhs) {
+        static_assert(K == K2, "Matrix shape mismatch (tns::fixed_tensor * matrix multiplication): the columns of lhs "
+                               "are not the rows of rhs");
+        fixed_tensor<type, R, C> result;
+        if constexpr (R * K * C <= fixed::unroll_limit) {
+            fixed::unroll<R * C>([&](auto ij) {
+                type sum = 0;
+                fixed::unroll<K>([&](auto k) { sum += lhs(ij / C, k) * rhs(k, ij % C); });
+                result(ij / C, ij % C) = sum;
+            });
+        } else {
+            for (size_t i = 0; i < R; ++i) {
+                for (size_t k = 0; k < K; ++k) {
+                    const type a = lhs(i, k);
+                    for (size_t j = 0; j < C; ++j) {
+                        result(i, j) += a * rhs(k, j);
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+} // tns
+
+template<typename type, size_t R, size_t C>
+std::ostream &operator<<(std::ostream &COUT, const tns::fixed_tensor<type, R, C> &tensor) {
+    const auto [min, max] = std::minmax_element(tensor.data().begin(), tensor.data().end());
+    tns::io::printTensor(COUT, tensor.data().data(), R, C, C, 1, *min, *max, static_cast<int>(COUT.precision()), true);
+    return COUT;
+}
+
+#endif //MATRIX_FIXED_TENSOR_H
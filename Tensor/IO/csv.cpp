@@ -0,0 +1,638 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+/**
+ * @file csv.cpp
+ * @brief Parallel CSV parser behind tensor::read_csv().
+ */
+
+#include "csv.h"
+#include "../Parallel/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace tns::io {
+
+    namespace {
+
+        using clock = std::chrono::steady_clock;
+
+        double secondsSince(clock::time_point start) {
+            return std::chrono::duration<double>(clock::now() - start).count();
+        }
+
+        // strtod needs a terminated string, so the cell is copied first
+        const char *parseWithStrtod(const char *first, const char *last, double &value) {
+            char buffer[128];
+            const size_t length = std::min<size_t>(last - first, sizeof(buffer) - 1);
+            std::memcpy(buffer, first, length);
+            buffer[length] = '\0';
+
+            char *end = nullptr;
+            value = std::strtod(buffer, &end);
+            return (end == buffer) ? nullptr : first + (end - buffer);
+        }
+
+        // Parse the number starting at first. Returns the end of the number, or nullptr if there is none.
+        const char *parseNumber(const char *first, const char *last, double &value) {
+#if defined(__cpp_lib_to_chars)
+            const auto [end, error] = std::from_chars(first, last, value);
+            if (error == std::errc()) {
+                return end;
+            }
+            // Values beyond the double range saturate to inf or 0 like strtod
+            return (error == std::errc::result_out_of_range) ? parseWithStrtod(first, last, value) : nullptr;
+#else
+            return parseWithStrtod(first, last, value);
+#endif
+        }
+
+        bool blank(char c) {
+            return c == ' ' || c == '\t';
+        }
+
+        // Parse the cell at p and leave p on the ',' or the end of the line. Returns false if it is not a number.
+        bool parseCell(const char *&p, const char *lineEnd, double &value) {
+            while (p < lineEnd && blank(*p)) {
+                ++p;
+            }
+            if (p < lineEnd && *p == '+') {
+                ++p;
+            }
+
+            const char *end = parseNumber(p, lineEnd, value);
+            if (end == nullptr) {
+                return false;
+            }
+            p = end;
+            while (p < lineEnd && blank(*p)) {
+                ++p;
+            }
+            return p == lineEnd || *p == ',';
+        }
+
+        std::string_view cellText(const char *cell, const char *lineEnd) {
+            return {cell, static_cast<size_t>(std::find(cell, lineEnd, ',') - cell)};
+        }
+
+        const char *trimCarriageReturn(const char *p, const char *lineEnd) {
+            return (lineEnd > p && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+        }
+
+        [[noreturn]] void invalidCell(size_t line, size_t column, const char *cell, const char *lineEnd) {
+            std::ostringstream message;
+            message << "\nInvalid number (tns::io::parseCsv()): line " << line << ", column " << column + 1
+                    << ": \"" << cellText(cell, lineEnd) << "\"";
+            throw std::invalid_argument(message.str());
+        }
+
+        // Parse one line into row, returns the number of cells written
+        template<typename type>
+        size_t parseLine(const char *p, const char *lineEnd, type *row, size_t maxCols, double decimal, size_t line) {
+            lineEnd = trimCarriageReturn(p, lineEnd);
+
+            size_t col = 0;
+            while (p < lineEnd && col < maxCols) {
+                const char *cell = p;
+                double value;
+                if (!parseCell(p, lineEnd, value)) {
+                    invalidCell(line, col, cell, lineEnd);
+                }
+
+                if (decimal > 0) {
+                    value = std::round(value * decimal) / decimal;
+                }
+                row[col++] = static_cast<type>(value);
+
+                ++p; // Skip the ',' (a trailing one ends the line)
+            }
+
+            return col;
+        }
+
+        // Cut [begin, size) into chunks that start at a line, a few per thread, at least 1 MB each
+        std::vector<size_t> lineChunks(const char *data, size_t begin, size_t size) {
+            const size_t target = std::max<size_t>(size_t(1) << 20, (size - begin) / (parallel::threadCount() * 4) + 1);
+            std::vector<size_t> bounds{begin};
+            while (bounds.back() < size) {
+                const size_t next = bounds.back() + target;
+                const void *newline = (next < size) ? std::memchr(data + next, '\n', size - next) : nullptr;
+                bounds.push_back((newline != nullptr) ? static_cast<const char *>(newline) - data + 1 : size);
+            }
+            return bounds;
+        }
+
+        // End of the line starting at p
+        const char *lineEnd(const char *p, const char *end) {
+            const void *newline = std::memchr(p, '\n', end - p);
+            return (newline != nullptr) ? static_cast<const char *>(newline) : end;
+        }
+
+        bool blankLine(const char *p, const char *end) {
+            return std::all_of(p, end, [](char c) { return blank(c) || c == '\r'; });
+        }
+
+        // What one chunk of loadCsv() parsed. Line numbers are relative to the first line of the chunk.
+        template<typename type>
+        struct chunk_result {
+            std::vector<type> values;
+            size_t rows = 0;
+            size_t lines = 0;
+            std::vector<csv_issue> issues;
+        };
+
+        // Append value to out, growing it when the cell does not fit (fixed notation of a huge double)
+        template<typename type>
+        void formatCell(std::string &out, size_t &used, type value, int precision) {
+            while (true) {
+                std::to_chars_result result{};
+                char *first = out.data() + used, *last = out.data() + out.size();
+                if constexpr (std::is_integral_v<type>) {
+                    result = std::to_chars(first, last, value);
+                } else if (precision < 0) {
+                    result = std::to_chars(first, last, value);
+                } else {
+                    result = std::to_chars(first, last, value, std::chars_format::fixed, precision);
+                }
+                if (result.ec == std::errc()) {
+                    used = result.ptr - out.data();
+                    return;
+                }
+                out.resize(out.size() * 2 + 512);
+            }
+        }
+
+        // Rows [begin, end) as CSV lines
+        template<typename type>
+        void formatRows(std::string &out, const type *data, size_t begin, size_t end, size_t cols, size_t rowStride,
+                        size_t colStride, int precision) {
+            out.resize(std::max<size_t>(out.size(), (end - begin) * cols * 24 + 64));
+            size_t used = 0;
+            for (size_t i = begin; i < end; ++i) {
+                const type *row = data + i * rowStride;
+                for (size_t j = 0; j < cols; ++j) {
+                    formatCell(out, used, row[j * colStride], precision);
+                    if (used == out.size()) {
+                        out.resize(out.size() * 2);
+                    }
+                    out[used++] = (j + 1 < cols) ? ',' : '\n';
+                }
+                if (cols == 0) {
+                    if (used == out.size()) {
+                        out.resize(out.size() * 2 + 1);
+                    }
+                    out[used++] = '\n';
+                }
+            }
+            out.resize(used);
+        }
+
+        std::string headerLine(const std::vector<std::string> &header) {
+            std::string line;
+            for (size_t j = 0; j < header.size(); ++j) {
+                const std::string &name = header[j];
+                if (name.find_first_of(",\"") == std::string::npos) {
+                    line += name;
+                } else {
+                    line += '"';
+                    for (char c : name) {
+                        line += (c == '"') ? "\"\"" : std::string(1, c);
+                    }
+                    line += '"';
+                }
+                line += (j + 1 < header.size()) ? ',' : '\n';
+            }
+            return line;
+        }
+
+    }
+
+    std::ostream &operator<<(std::ostream &COUT, const csv_stats &stats) {
+        const auto flags = COUT.flags();
+        const auto precision = COUT.precision();
+
+        COUT << std::fixed << std::setprecision(1)
+             << stats.bytes * 1e-6 << " MB, " << stats.rows << " x " << stats.cols << '\n'
+             << "  map:   " << std::setw(9) << stats.mapSeconds * 1e3 << " ms\n"
+             << "  index: " << std::setw(9) << stats.indexSeconds * 1e3 << " ms | "
+             << std::setw(9) << stats.mbPerSecond(stats.indexSeconds) << " MB/s\n"
+             << "  parse: " << std::setw(9) << stats.parseSeconds * 1e3 << " ms | "
+             << std::setw(9) << stats.mbPerSecond(stats.parseSeconds) << " MB/s\n"
+             << "  total: " << std::setw(9) << stats.totalSeconds() * 1e3 << " ms | "
+             << std::setw(9) << stats.mbPerSecond(stats.totalSeconds()) << " MB/s\n";
+
+        COUT.flags(flags);
+        COUT.precision(precision);
+        return COUT;
+    }
+
+    size_t countCells(std::string_view line) {
+        const char *p = line.data(), *end = trimCarriageReturn(p, p + line.size());
+        while (end > p && blank(end[-1])) {
+            --end;
+        }
+        if (end == p) {
+            return 0;
+        }
+        return static_cast<size_t>(std::count(p, end, ',')) + (end[-1] != ',');
+    }
+
+    std::vector<std::string> splitHeader(std::string_view line) {
+        const char *p = line.data(), *end = trimCarriageReturn(p, p + line.size());
+        std::vector<std::string> names;
+        if (blankLine(p, end)) {
+            return names;
+        }
+        while (p <= end) {
+            const char *cellEnd = std::find(p, end, ',');
+            const char *first = p, *last = cellEnd;
+            while (first < last && blank(*first)) {
+                ++first;
+            }
+            while (last > first && blank(last[-1])) {
+                --last;
+            }
+            if (last - first >= 2 && *first == '"' && last[-1] == '"') {
+                ++first;
+                --last;
+            }
+            if (cellEnd == end && first == last && !names.empty() && cellEnd[-1] == ',') {
+                break; // Trailing ','
+            }
+            names.emplace_back(first, last);
+            p = cellEnd + 1;
+        }
+        return names;
+    }
+
+    csv_row_parser::csv_row_parser(const csv_options &options, const std::vector<std::string> &header, size_t width)
+            : _width(width), _selected(options.columns), _needed(width, 0),
+              _decimal((options.precision >= 0) ? std::pow(10.0, options.precision) : 0), _cells(width) {
+        for (const std::string &name: options.columnNames) {
+            const auto found = std::find(header.begin(), header.end(), name);
+            if (found == header.end()) {
+                throw std::invalid_argument("\nUnknown column (tns::io::csv_row_parser): \"" + name + "\""
+                                            + (options.header ? "" : ", the file has no header"));
+            }
+            _selected.push_back(static_cast<size_t>(found - header.begin()));
+        }
+
+        if (options.columns.empty() && options.columnNames.empty()) {
+            _selected.resize(width);
+            std::iota(_selected.begin(), _selected.end(), size_t(0));
+        }
+        for (size_t column: _selected) {
+            if (column >= width) {
+                std::ostringstream message;
+                message << "\nColumn out of range (tns::io::csv_row_parser): " << column << " of " << width
+                        << " columns";
+                throw std::invalid_argument(message.str());
+            }
+            _needed[column] = 1;
+        }
+    }
+
+    template<typename type>
+    csv_row_parser::result csv_row_parser::parse(std::string_view line, type *row, std::string &reason) {
+        const char *p = line.data(), *end = trimCarriageReturn(p, p + line.size());
+        if (blankLine(p, end)) {
+            return result::blank;
+        }
+
+        // Split every cell, only the selected ones are converted
+        size_t col = 0;
+        while (true) {
+            if (col == _width) {
+                col += countCells({p, static_cast<size_t>(end - p)}); // Count the extra cells for the reason
+                break;
+            }
+            const char *cell = p;
+            if (_needed[col]) {
+                if (!parseCell(p, end, _cells[col])) {
+                    std::ostringstream message;
+                    message << "column " << col + 1 << " is not a number: \"" << cellText(cell, end) << "\"";
+                    reason = message.str();
+                    return result::rejected;
+                }
+            } else {
+                p = std::find(p, end, ',');
+            }
+            ++col;
+            if (p == end || ++p == end) {
+                break; // Last cell, or a trailing ','
+            }
+        }
+
+        if (col != _width) {
+            std::ostringstream message;
+            message << col << " cells, expected " << _width;
+            reason = message.str();
+            return result::rejected;
+        }
+
+        for (size_t k = 0; k < _selected.size(); ++k) {
+            double value = _cells[_selected[k]];
+            if (_decimal > 0) {
+                value = std::round(value * _decimal) / _decimal;
+            }
+            row[k] = static_cast<type>(value);
+        }
+        return result::row;
+    }
+
+    template<typename type>
+    size_t parseCsv(std::string_view text, type *out, size_t maxRows, size_t maxCols, size_t rowStride,
+                    int precision, csv_stats *stats) {
+        const char *data = text.data();
+        const size_t size = text.size();
+
+        // Index: cut the text into chunks that start at a line
+        auto start = clock::now();
+
+        const std::vector<size_t> bounds = lineChunks(data, 0, size);
+        const size_t chunks = bounds.size() - 1;
+
+        // Only the last chunk can end without '\n'
+        std::vector<size_t> firstRow(chunks + 1, 0);
+        parallel::parallelFor(0, chunks, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                size_t lines = 0;
+                const char *p = data + bounds[c], *chunkEnd = data + bounds[c + 1];
+                while ((p = static_cast<const char *>(std::memchr(p, '\n', chunkEnd - p))) != nullptr) {
+                    ++lines;
+                    ++p;
+                }
+                const bool unterminated = (c + 1 == chunks) && size != 0 && data[size - 1] != '\n';
+                firstRow[c + 1] = lines + unterminated;
+            }
+        });
+        for (size_t c = 0; c < chunks; ++c) {
+            firstRow[c + 1] += firstRow[c];
+        }
+
+        const double indexSeconds = secondsSince(start);
+
+        // Parse: every chunk knows its first row, so the chunks are independent
+        start = clock::now();
+
+        const double decimal = (precision >= 0) ? std::pow(10.0, precision) : 0;
+        std::vector<size_t> widest(chunks, 0);
+        parallel::parallelFor(0, chunks, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                size_t row = firstRow[c];
+                const char *p = data + bounds[c], *chunkEnd = data + bounds[c + 1];
+
+                while (p < chunkEnd && row < maxRows) {
+                    const char *end = lineEnd(p, chunkEnd);
+
+                    const size_t cols = parseLine(p, end, out + row * rowStride, maxCols, decimal, row + 1);
+                    widest[c] = std::max(widest[c], cols);
+
+                    ++row;
+                    p = end + 1;
+                }
+            }
+        });
+
+        const size_t rows = std::min(firstRow[chunks], maxRows);
+        if (stats != nullptr) {
+            stats->bytes = size;
+            stats->rows = rows;
+            stats->cols = widest.empty() ? 0 : *std::max_element(widest.begin(), widest.end());
+            stats->indexSeconds = indexSeconds;
+            stats->parseSeconds = secondsSince(start);
+        }
+
+        return rows;
+    }
+
+    template<typename type>
+    void csv_table<type>::copyTo(type *out) const {
+        std::vector<size_t> offsets(chunks.size() + 1, 0);
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            offsets[c + 1] = offsets[c] + chunks[c].size();
+        }
+
+        parallel::parallelFor(0, chunks.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                std::copy(chunks[c].begin(), chunks[c].end(), out + offsets[c]);
+            }
+        });
+    }
+
+    template<typename type>
+    csv_table<type> loadCsv(std::string_view text, const csv_options &options, csv_report *report) {
+        const char *data = text.data();
+        const size_t size = text.size();
+
+        // Index: header, width from the first data line, then line-aligned chunks
+        auto start = clock::now();
+
+        size_t offset = 0, headerLines = 0;
+        std::vector<std::string> header;
+        if (options.header && size != 0) {
+            const char *end = lineEnd(data, data + size);
+            header = splitHeader({data, static_cast<size_t>(end - data)});
+            offset = std::min<size_t>(end - data + 1, size);
+            headerLines = 1;
+        }
+
+        size_t width = header.size();
+        if (!options.header) {
+            for (const char *p = data; p < data + size; ) {
+                const char *end = lineEnd(p, data + size);
+                if (!blankLine(p, end)) {
+                    width = countCells({p, static_cast<size_t>(end - p)});
+                    break;
+                }
+                p = end + 1;
+            }
+        }
+
+        const csv_row_parser parser(options, header, width);
+        const size_t cols = parser.cols();
+
+        const std::vector<size_t> bounds = lineChunks(data, offset, size);
+        const size_t chunks = bounds.size() - 1;
+
+        const double indexSeconds = secondsSince(start);
+
+        // Parse: one pass per chunk into its own growing buffer
+        start = clock::now();
+
+        const double bytesPerRow = (options.rowHint != 0) ? double(size - offset) / double(options.rowHint) : 0;
+        std::vector<chunk_result<type>> results(chunks);
+        // Index of the first chunk with a rejected line: only the chunks after it stop early, so every chunk before
+        // it runs to its end and numbers its lines
+        std::atomic<size_t> firstFailure{chunks};
+
+        parallel::parallelFor(0, chunks, 1, [&](size_t begin, size_t end) {
+            csv_row_parser local = parser; // Own scratch row
+            std::vector<type> row(cols);
+            std::string reason;
+
+            for (size_t c = begin; c < end; ++c) {
+                chunk_result<type> &result = results[c];
+                const char *p = data + bounds[c], *chunkEnd = data + bounds[c + 1];
+                if (bytesPerRow > 0) {
+                    result.values.reserve(static_cast<size_t>(double(chunkEnd - p) / bytesPerRow + 1) * cols);
+                }
+
+                bool stop = false;
+                while (p < chunkEnd && !stop && firstFailure.load(std::memory_order_relaxed) >= c) {
+                    const char *next = lineEnd(p, chunkEnd);
+                    ++result.lines;
+
+                    switch (local.parse({p, static_cast<size_t>(next - p)}, row.data(), reason)) {
+                        case csv_row_parser::result::row:
+                            result.values.insert(result.values.end(), row.begin(), row.end());
+                            ++result.rows;
+                            break;
+                        case csv_row_parser::result::rejected:
+                            result.issues.push_back({result.lines, reason});
+                            if (!options.skipBadLines) {
+                                size_t first = firstFailure.load(std::memory_order_relaxed);
+                                while (c < first && !firstFailure.compare_exchange_weak(first, c,
+                                                                                         std::memory_order_relaxed)) {}
+                                stop = true;
+                            }
+                            break;
+                        case csv_row_parser::result::blank:
+                            break;
+                    }
+
+                    p = next + 1;
+                }
+            }
+        });
+
+        // Line numbers: a chunk starts after the lines of the chunks before it. Every chunk before the first
+        // failing one ran to its end, and that one stopped at its first issue, which is the first bad line.
+        csv_table<type> table;
+        table.cols = cols;
+        std::vector<csv_issue> skipped;
+        size_t line = headerLines;
+        for (chunk_result<type> &result: results) {
+            for (csv_issue &issue: result.issues) {
+                issue.line += line;
+                if (!options.skipBadLines) {
+                    std::ostringstream message;
+                    message << "\nMalformed line (tns::io::loadCsv()): line " << issue.line << ": " << issue.reason;
+                    throw std::invalid_argument(message.str());
+                }
+                skipped.push_back(std::move(issue));
+            }
+            line += result.lines;
+            table.rows += result.rows;
+            table.chunks.push_back(std::move(result.values));
+        }
+
+        if (report != nullptr) {
+            report->header = std::move(header);
+            report->skipped = std::move(skipped);
+            report->stats.bytes = size;
+            report->stats.rows = table.rows;
+            report->stats.cols = cols;
+            report->stats.indexSeconds = indexSeconds;
+            report->stats.parseSeconds = secondsSince(start);
+        }
+
+        return table;
+    }
+
+    template<typename type>
+    void writeCsv(const std::string &filename, const type *data, size_t rows, size_t cols, size_t rowStride,
+                  size_t colStride, int precision, const std::vector<std::string> &header) {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("\nError opening file (tns::io::writeCsv()): " + filename);
+        }
+
+        if (!header.empty()) {
+            const std::string line = headerLine(header);
+            file.write(line.data(), static_cast<std::streamsize>(line.size()));
+        }
+
+        // About 1 MB of text per chunk, a few chunks per thread in flight
+        const size_t chunkRows = std::max<size_t>(1, (size_t(1) << 20) / (std::max<size_t>(cols, 1) * 16));
+        const size_t groupChunks = parallel::threadCount() * 4;
+        std::vector<std::string> buffers(groupChunks);
+
+        for (size_t first = 0; first < rows; first += chunkRows * groupChunks) {
+            const size_t chunks = std::min(groupChunks, (rows - first + chunkRows - 1) / chunkRows);
+            auto format = [&](size_t begin, size_t end) {
+                for (size_t c = begin; c < end; ++c) {
+                    const size_t rowBegin = first + c * chunkRows;
+                    formatRows(buffers[c], data, rowBegin, std::min(rows, rowBegin + chunkRows), cols, rowStride,
+                               colStride, precision);
+                }
+            };
+            if (chunks > 1 && parallel::threadCount() > 1) {
+                parallel::parallelFor(0, chunks, 1, format);
+            } else {
+                format(0, chunks);
+            }
+
+            for (size_t c = 0; c < chunks; ++c) {
+                file.write(buffers[c].data(), static_cast<std::streamsize>(buffers[c].size()));
+            }
+            if (!file) {
+                break;
+            }
+        }
+
+        file.flush();
+        if (!file) {
+            throw std::runtime_error("\nError writing file (tns::io::writeCsv()): " + filename);
+        }
+    }
+
+    template size_t parseCsv<int>(std::string_view, int *, size_t, size_t, size_t, int, csv_stats *);
+
+    template size_t parseCsv<double>(std::string_view, double *, size_t, size_t, size_t, int, csv_stats *);
+
+    template size_t parseCsv<float>(std::string_view, float *, size_t, size_t, size_t, int, csv_stats *);
+
+    template struct csv_table<int>;
+
+    template struct csv_table<double>;
+
+    template struct csv_table<float>;
+
+    template csv_row_parser::result csv_row_parser::parse<int>(std::string_view, int *, std::string &);
+
+    template csv_row_parser::result csv_row_parser::parse<double>(std::string_view, double *, std::string &);
+
+    template csv_row_parser::result csv_row_parser::parse<float>(std::string_view, float *, std::string &);
+
+    template csv_table<int> loadCsv<int>(std::string_view, const csv_options &, csv_report *);
+
+    template csv_table<double> loadCsv<double>(std::string_view, const csv_options &, csv_report *);
+
+    template csv_table<float> loadCsv<float>(std::string_view, const csv_options &, csv_report *);
+
+    template void writeCsv<int>(const std::string &, const int *, size_t, size_t, size_t, size_t, int,
+                                const std::vector<std::string> &);
+
+    template void writeCsv<double>(const std::string &, const double *, size_t, size_t, size_t, size_t, int,
+                                   const std::vector<std::string> &);
+
+    template void writeCsv<float>(const std::string &, const float *, size_t, size_t, size_t, size_t, int,
+                                  const std::vector<std::string> &);
+
+} // tns::io
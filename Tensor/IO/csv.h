@@ -0,0 +1,203 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_CSV_H
+#define MATRIX_CSV_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tns::io {
+
+    /**
+     * @brief Size and per-stage timing of one CSV load, filled by tensor::read_csv() when requested.
+     */
+    struct csv_stats {
+        size_t bytes = 0;         // Bytes scanned
+        size_t rows = 0;          // Lines parsed into the tensor
+        size_t cols = 0;          // Widest parsed line, capped by the tensor width
+        double mapSeconds = 0;    // Opening and mapping the file
+        double indexSeconds = 0;  // Splitting the file into line-aligned chunks and counting their lines
+        double parseSeconds = 0;  // Converting the cells, in parallel
+
+        [[nodiscard]] double totalSeconds() const { return mapSeconds + indexSeconds + parseSeconds; }
+
+        /**
+         * @brief Throughput of a stage in MB/s (10^6 bytes), e.g. `stats.mbPerSecond(stats.parseSeconds)`.
+         */
+        [[nodiscard]] double mbPerSecond(double seconds) const {
+            return (seconds > 0) ? static_cast<double>(bytes) / seconds * 1e-6 : 0;
+        }
+    };
+
+    std::ostream &operator<<(std::ostream &COUT, const csv_stats &stats);
+
+    /**
+     * @brief How loadCsv() and the shape-discovering tensor::read_csv() read a file.
+     */
+    struct csv_options {
+        bool header = false;                  // The first line holds the column names
+        std::vector<size_t> columns;          // Columns to keep, in this order (0-based, repeats allowed)
+        std::vector<std::string> columnNames; // Columns to keep by header name, appended after columns
+        size_t rowHint = 0;                   // Expected number of rows, reserved up front (0: grow from empty)
+        int precision = -1;                   // Round to this many decimals, negative to keep the parsed values
+        bool skipBadLines = false;            // Skip ragged or malformed lines and report them instead of throwing
+        bool cache = false;                   // read_csv(): reuse a binary copy next to the file (see csv_cache.h)
+    };
+
+    /**
+     * @brief A line rejected by loadCsv().
+     */
+    struct csv_issue {
+        size_t line;        // 1-based line number in the file
+        std::string reason; // e.g. "9 cells, expected 10"
+    };
+
+    /**
+     * @brief What loadCsv() found besides the values, filled when requested.
+     */
+    struct csv_report {
+        std::vector<std::string> header; // Column names, when csv_options::header is set
+        std::vector<csv_issue> skipped;  // Lines skipped with csv_options::skipBadLines, in file order
+        csv_stats stats;
+    };
+
+    /**
+     * @brief Number of cells of a CSV line, a trailing ',' does not start one. 0 for a blank line.
+     */
+    size_t countCells(std::string_view line);
+
+    /**
+     * @brief Split a header line into column names, without the blanks and double quotes around them.
+     */
+    std::vector<std::string> splitHeader(std::string_view line);
+
+    /**
+     * @brief Converts the lines of a CSV file of known width into rows of the selected columns.
+     *
+     * @details
+     * Shared by loadCsv() and csv_batch_reader. Holds a scratch row, so every thread needs its own copy.
+     */
+    class csv_row_parser {
+        size_t _width = 0;
+        std::vector<size_t> _selected; // Source column of every output column
+        std::vector<char> _needed;     // Whether a source column is selected at all
+        double _decimal = 0;           // 10^precision, 0 to keep the parsed values
+        std::vector<double> _cells;
+
+    public:
+        enum class result { row, blank, rejected };
+
+        /**
+         * @brief Resolve the selected columns of options against the header and the width of the file.
+         *
+         * @throws std::invalid_argument If a selected column does not exist.
+         */
+        csv_row_parser(const csv_options &options, const std::vector<std::string> &header, size_t width);
+
+        /**
+         * @brief Number of cells of every line.
+         */
+        [[nodiscard]] size_t width() const { return _width; }
+
+        /**
+         * @brief Number of selected columns, the width of a row.
+         */
+        [[nodiscard]] size_t cols() const { return _selected.size(); }
+
+        /**
+         * @brief Parse one line (without its '\n') into row.
+         *
+         * @param line The line, a trailing '\r' is ignored.
+         * @param row Receives cols() values when the result is row, untouched otherwise.
+         * @param reason Receives why the line was rejected, e.g. "9 cells, expected 10".
+         */
+        template<typename type>
+        result parse(std::string_view line, type *row, std::string &reason);
+    };
+
+    /**
+     * @brief Rows parsed by loadCsv(), still split by chunk.
+     */
+    template<typename type>
+    struct csv_table {
+        size_t rows = 0;
+        size_t cols = 0;
+        std::vector<std::vector<type>> chunks; // Row-major rows of every chunk, in file order
+
+        /**
+         * @brief Copy the rows into a contiguous rows x cols buffer, one chunk per task.
+         */
+        void copyTo(type *out) const;
+    };
+
+    /**
+     * @brief Parse numeric CSV text whose shape is not known in advance.
+     *
+     * @details
+     * The width is taken from the header, or from the first non-blank line. The text is then cut into line-aligned
+     * chunks, and every chunk is parsed in a single pass, in parallel, into its own buffer that grows geometrically
+     * (pre-reserved from csv_options::rowHint). Blank lines are ignored. A line with another number of cells is
+     * ragged; it throws, or is skipped and reported with csv_options::skipBadLines, like a cell that is not a
+     * number. Unselected columns are only split, not parsed.
+     *
+     * @param text The CSV content.
+     * @param options Header, column selection, row hint, precision and error policy.
+     * @param report If not null, receives the header, the skipped lines, the shape and the index and parse times.
+     * @return The parsed rows.
+     * @throws std::invalid_argument On the first ragged or malformed line (with its line number) unless
+     * skipBadLines is set, or if a selected column does not exist.
+     */
+    template<typename type>
+    csv_table<type> loadCsv(std::string_view text, const csv_options &options = {}, csv_report *report = nullptr);
+
+    /**
+     * @brief Parse numeric CSV text into a row-major buffer.
+     *
+     * @details
+     * The text is cut into line-aligned chunks. The lines of every chunk are counted in parallel to give each chunk
+     * its first row index, then the chunks are parsed in parallel with std::from_chars, straight into out. Lines
+     * past maxRows and cells past maxCols are ignored, missing ones are left untouched. "\r\n" line endings,
+     * blanks around cells and a leading '+' are accepted.
+     *
+     * @param text The CSV content.
+     * @param out Destination, element (i, j) is written at out[i * rowStride + j].
+     * @param maxRows Number of rows of out.
+     * @param maxCols Number of columns of out.
+     * @param rowStride Distance between two rows of out.
+     * @param precision Round every value to this many decimals, or keep it as parsed if negative.
+     * @param stats If not null, receives the byte and row counts and the index and parse times.
+     * @return The number of rows written.
+     * @throws std::invalid_argument If a cell is not a number, with its line and column.
+     */
+    template<typename type>
+    size_t parseCsv(std::string_view text, type *out, size_t maxRows, size_t maxCols, size_t rowStride,
+                    int precision, csv_stats *stats = nullptr);
+
+    /**
+     * @brief Write a strided matrix as CSV.
+     *
+     * @details
+     * Rows are cut into chunks of about 1 MB of text. A few chunks per thread are formatted in parallel with
+     * std::to_chars into their own buffers, then written in order, one write per chunk, before the next group is
+     * formatted; the memory used stays bounded whatever the size of the matrix. "inf" and "nan" are written as is
+     * and read back by parseCsv() and loadCsv().
+     *
+     * @param filename The name of the CSV file, replaced if it exists.
+     * @param data Element (i, j) is data[i * rowStride + j * colStride].
+     * @param precision Number of decimals (fixed notation), or negative for the shortest text that reads back to
+     * the same value. Ignored for integers.
+     * @param header Column names written as the first line if not empty; names with ',' or '"' are quoted.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    template<typename type>
+    void writeCsv(const std::string &filename, const type *data, size_t rows, size_t cols, size_t rowStride,
+                  size_t colStride, int precision = -1, const std::vector<std::string> &header = {});
+
+} // tns::io
+
+#endif //MATRIX_CSV_H
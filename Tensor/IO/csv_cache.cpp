@@ -0,0 +1,129 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+/**
+ * @file csv_cache.cpp
+ * @brief Binary sidecar cache of parsed CSV files, stored as weight files.
+ */
+
+#include "csv_cache.h"
+#include "npy.h"
+#include "weights.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace tns::io {
+
+    namespace {
+
+        const std::string SKIPPED = "skipped lines";
+
+        const char *const CACHED_REASON = "skipped when the cache was built";
+
+    }
+
+    std::string csvCachePath(const std::string &filename) {
+        return filename + ".tnscache";
+    }
+
+    std::string csvCacheKey(const std::string &filename, const csv_options &options, const std::string &descr) {
+        std::ostringstream parsing;
+        parsing << options.header << ';' << options.precision << ';' << options.skipBadLines << ';';
+        for (size_t column: options.columns) {
+            parsing << column << ',';
+        }
+        parsing << ';';
+        for (const std::string &name: options.columnNames) {
+            parsing << name.size() << ':' << name << ',';
+        }
+        const std::string text = parsing.str();
+
+        std::ostringstream key;
+        key << "csv-cache 1 size=" << std::filesystem::file_size(filename)
+            << " mtime=" << std::filesystem::last_write_time(filename).time_since_epoch().count()
+            << " type=" << descr << " options=" << std::hex << checksum64(text.data(), text.size());
+        return key.str();
+    }
+
+    template<typename type>
+    bool loadCsvCache(const std::string &filename, const csv_options &options, tensor<type> &values,
+                      csv_report *report) {
+        const std::string path = csvCachePath(filename);
+        if (!std::filesystem::exists(path)) {
+            return false;
+        }
+
+        try {
+            const auto start = std::chrono::steady_clock::now();
+            const std::string key = csvCacheKey(filename, options, npyDescr<type>());
+            const weight_file cache(path);
+            if (cache.entries().size() != 2 || cache.entries()[0].name != key) {
+                return false;
+            }
+            values = cache.get<type>(key);
+
+            if (report != nullptr) {
+                const tensor<double> lines = cache.get<double>(SKIPPED);
+                report->skipped.clear();
+                for (double line: lines.data()) {
+                    report->skipped.push_back({static_cast<size_t>(line), CACHED_REASON});
+                }
+
+                report->header.clear();
+                std::ifstream source(filename);
+                std::string first;
+                if (options.header && std::getline(source, first)) {
+                    report->header = splitHeader(first);
+                }
+
+                report->stats = csv_stats{};
+                report->stats.bytes = std::filesystem::file_size(path);
+                report->stats.rows = values.row();
+                report->stats.cols = values.col();
+                report->stats.mapSeconds =
+                        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+            return true;
+        } catch (const std::exception &) {
+            return false; // Unreadable or corrupted: parse the CSV again and overwrite it
+        }
+    }
+
+    template<typename type>
+    void storeCsvCache(const std::string &filename, const std::string &key, const tensor<type> &values,
+                       const csv_report &report) noexcept {
+        try {
+            tensor<double> lines(report.skipped.size(), 1);
+            for (size_t k = 0; k < report.skipped.size(); ++k) {
+                lines.data()[k] = static_cast<double>(report.skipped[k].line);
+            }
+
+            weight_writer writer(csvCachePath(filename));
+            writer.add(key, values);
+            writer.add(SKIPPED, lines);
+            writer.close();
+        } catch (...) {
+            // The writer deleted its temporary file, the previous cache (if any) is left as it was
+        }
+    }
+
+    template bool loadCsvCache<int>(const std::string &, const csv_options &, tensor<int> &, csv_report *);
+
+    template bool loadCsvCache<double>(const std::string &, const csv_options &, tensor<double> &, csv_report *);
+
+    template bool loadCsvCache<float>(const std::string &, const csv_options &, tensor<float> &, csv_report *);
+
+    template void storeCsvCache<int>(const std::string &, const std::string &, const tensor<int> &,
+                                     const csv_report &) noexcept;
+
+    template void storeCsvCache<double>(const std::string &, const std::string &, const tensor<double> &,
+                                        const csv_report &) noexcept;
+
+    template void storeCsvCache<float>(const std::string &, const std::string &, const tensor<float> &,
+                                       const csv_report &) noexcept;
+
+} // tns::io
@@ -0,0 +1,55 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_CSV_CACHE_H
+#define MATRIX_CSV_CACHE_H
+
+#include "csv.h"
+#include "../tensor.h"
+
+#include <string>
+
+namespace tns::io {
+
+    /**
+     * @brief Path of the binary cache of a CSV file: filename + ".tnscache". There is one cache per file, replaced
+     * whenever it is read with another key.
+     */
+    std::string csvCachePath(const std::string &filename);
+
+    /**
+     * @brief Key of the cache of a CSV file: its size and modification time, the element type and the options
+     * that change the parsed values (header, columns, precision, skipBadLines).
+     *
+     * @throws std::filesystem::filesystem_error If the file does not exist.
+     */
+    std::string csvCacheKey(const std::string &filename, const csv_options &options, const std::string &descr);
+
+    /**
+     * @brief Load the cache of filename if its key matches.
+     *
+     * @details
+     * The cache is a weight file (see weights.h) whose first tensor, named after the key, holds the values and the
+     * second one the numbers of the skipped lines. The values are borrowed from the mapped cache. On a hit, report
+     * receives the header (read again from the first line of the CSV file), the skipped lines and the size of the
+     * cache; the index and parse times are 0.
+     *
+     * @return false if there is no cache, or it is stale or unreadable.
+     */
+    template<typename type>
+    bool loadCsvCache(const std::string &filename, const csv_options &options, tensor<type> &values,
+                      csv_report *report);
+
+    /**
+     * @brief Write the cache of filename, best effort: failures (e.g. a read-only directory) are ignored.
+     *
+     * @param key The key computed before parsing, so a file modified meanwhile leaves a stale cache behind.
+     */
+    template<typename type>
+    void storeCsvCache(const std::string &filename, const std::string &key, const tensor<type> &values,
+                       const csv_report &report) noexcept;
+
+} // tns::io
+
+#endif //MATRIX_CSV_CACHE_H
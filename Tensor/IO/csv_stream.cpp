@@ -0,0 +1,216 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+/**
+ * @file csv_stream.cpp
+ * @brief Prefetching mini-batch CSV reader.
+ */
+
+#include "csv_stream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace tns::io {
+
+    template<typename type>
+    csv_batch_reader<type>::csv_batch_reader(const std::string &filename, size_t batchRows,
+                                             const csv_options &options, size_t depth, size_t bufferBytes)
+            : _batchRows(batchRows), _options(options), _current(std::max<size_t>(depth, 2)),
+              _buffer(std::max<size_t>(bufferBytes, 4096)) {
+        if (batchRows == 0) {
+            throw std::invalid_argument("\nBatch of 0 rows (tns::io::csv_batch_reader)");
+        }
+
+        // _buffer already holds the bytes, the stream buffer would only add a copy
+        _file.rdbuf()->pubsetbuf(nullptr, 0);
+        _file.open(filename, std::ios::binary);
+        if (!_file.is_open()) {
+            throw std::runtime_error("\nError opening file (tns::io::csv_batch_reader): " + filename);
+        }
+
+        // Width from the header, or from the first non-blank line, which is put back for the producer
+        std::string_view line;
+        size_t width = 0;
+        if (options.header) {
+            if (readLine(line)) {
+                _header = splitHeader(line);
+            }
+            width = _header.size();
+        } else {
+            while (readLine(line)) {
+                width = countCells(line);
+                if (width != 0) {
+                    _begin = line.data() - _buffer.data();
+                    --_line;
+                    break;
+                }
+            }
+        }
+
+        csv_row_parser parser(options, _header, width);
+        _cols = parser.cols();
+
+        for (size_t k = 0; k < _current; ++k) {
+            _slots.emplace_back(batchRows, _cols);
+            _free.push_back(k);
+        }
+
+        _producer = std::thread(&csv_batch_reader::produce, this, std::move(parser));
+    }
+
+    template<typename type>
+    csv_batch_reader<type>::~csv_batch_reader() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _changed.notify_all();
+        _producer.join();
+    }
+
+    template<typename type>
+    const tensor<type> *csv_batch_reader<type>::next() {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (_current != _slots.size()) {
+            _free.push_back(_current);
+            _current = _slots.size();
+            _changed.notify_all();
+        }
+
+        _changed.wait(lock, [this] { return !_ready.empty() || _done; });
+
+        // Batches parsed before an error are still delivered
+        if (!_ready.empty()) {
+            _current = _ready.front();
+            _ready.pop_front();
+            return &_slots[_current];
+        }
+        if (_error) {
+            std::rethrow_exception(std::exchange(_error, nullptr));
+        }
+        return nullptr;
+    }
+
+    template<typename type>
+    bool csv_batch_reader<type>::readLine(std::string_view &line) {
+        while (true) {
+            char *data = _buffer.data();
+            const void *newline = std::memchr(data + _begin, '\n', _end - _begin);
+            if (newline != nullptr) {
+                const size_t length = static_cast<const char *>(newline) - (data + _begin);
+                line = {data + _begin, length};
+                _begin += length + 1;
+                ++_line;
+                return true;
+            }
+
+            if (!_file) {
+                if (_begin == _end) {
+                    return false;
+                }
+                line = {data + _begin, _end - _begin}; // Last line without '\n'
+                _begin = _end;
+                ++_line;
+                return true;
+            }
+
+            // Move the partial line to the front, grow only if it fills the buffer, then refill
+            if (_begin != 0) {
+                std::memmove(data, data + _begin, _end - _begin);
+                _end -= _begin;
+                _begin = 0;
+            }
+            if (_end == _buffer.size()) {
+                _buffer.resize(_buffer.size() * 2);
+                data = _buffer.data();
+            }
+            _file.read(data + _end, static_cast<std::streamsize>(_buffer.size() - _end));
+            _end += static_cast<size_t>(_file.gcount());
+        }
+    }
+
+    template<typename type>
+    void csv_batch_reader<type>::produce(csv_row_parser parser) {
+        std::string reason;
+
+        try {
+            bool more = true;
+            while (more) {
+                size_t slot;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _changed.wait(lock, [this] { return _stopping || !_free.empty(); });
+                    if (_stopping) {
+                        break;
+                    }
+                    slot = _free.front();
+                    _free.pop_front();
+                }
+
+                type *out = _slots[slot].data().data();
+                size_t rows = 0;
+                std::string_view line;
+                while (rows < _batchRows && (more = readLine(line))) {
+                    switch (parser.parse(line, out + rows * _cols, reason)) {
+                        case csv_row_parser::result::row:
+                            ++rows;
+                            break;
+                        case csv_row_parser::result::rejected:
+                            if (!_options.skipBadLines) {
+                                std::ostringstream message;
+                                message << "\nMalformed line (tns::io::csv_batch_reader): line " << _line << ": "
+                                        << reason;
+                                throw std::invalid_argument(message.str());
+                            }
+                            _skipped.push_back({_line, reason});
+                            break;
+                        case csv_row_parser::result::blank:
+                            break;
+                    }
+                }
+
+                if (rows == 0) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _free.push_back(slot);
+                    break;
+                }
+                if (rows < _batchRows) {
+                    tensor<type> last(rows, _cols);
+                    std::copy_n(out, rows * _cols, last.data().data());
+                    _slots[slot] = std::move(last);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _ready.push_back(slot);
+                }
+                _changed.notify_all();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _done = true;
+        }
+        _changed.notify_all();
+    }
+
+} // tns::io
+
+template
+class tns::io::csv_batch_reader<int>;
+
+template
+class tns::io::csv_batch_reader<double>;
+
+template
+class tns::io::csv_batch_reader<float>;
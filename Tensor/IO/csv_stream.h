@@ -0,0 +1,127 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_CSV_STREAM_H
+#define MATRIX_CSV_STREAM_H
+
+#include "csv.h"
+#include "../tensor.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tns::io {
+
+    /**
+     * @brief Reads a CSV file as a sequence of fixed-size row batches, with bounded memory.
+     *
+     * @details
+     * A background thread reads the file through a small byte buffer and parses the next batches while the
+     * current one is consumed. Batches live in a ring of `depth` tensors that are reused, so the memory held is
+     * about `depth` batches plus the longest line, whatever the size of the file. The last batch has the remaining
+     * rows and is the only one allocated after construction.
+     *
+     * @code
+     * tns::io::csv_batch_reader<double> reader("train.csv", 256);
+     * while (const tns::tensor<double> *batch = reader.next()) {
+     *     // use *batch until the next call to next()
+     * }
+     * @endcode
+     *
+     * @tparam type The element type of the batches.
+     */
+    template<typename type>
+    class csv_batch_reader {
+        std::ifstream _file;
+        size_t _batchRows;
+        csv_options _options;
+        std::vector<std::string> _header;
+        std::vector<csv_issue> _skipped;
+        size_t _cols = 0;
+
+        // Ring of batches: the producer fills free slots and hands them over through _ready
+        std::vector<tensor<type>> _slots;
+        std::deque<size_t> _free, _ready;
+        size_t _current;                // Slot held by the consumer, _slots.size() when none
+        bool _done = false;             // The producer has finished (end of file, error or stop)
+        bool _stopping = false;
+        std::exception_ptr _error;
+        std::mutex _mutex;
+        std::condition_variable _changed;
+        std::thread _producer;
+
+        // Line buffer of the producer
+        std::vector<char> _buffer;
+        size_t _begin = 0, _end = 0;
+        size_t _line = 0;
+
+    public:
+        /**
+         * @brief Open filename and start prefetching.
+         *
+         * @param filename The name of the CSV file.
+         * @param batchRows Number of rows of every batch but the last.
+         * @param options Header, column selection, precision and error policy (rowHint is not used).
+         * @param depth Number of batches in the ring, at least 2: one consumed while the others are filled.
+         * @param bufferBytes Size of the read buffer, it grows only for a longer line.
+         * @throws std::runtime_error If the file cannot be opened.
+         * @throws std::invalid_argument If a selected column does not exist.
+         */
+        csv_batch_reader(const std::string &filename, size_t batchRows, const csv_options &options = {},
+                         size_t depth = 3, size_t bufferBytes = size_t(1) << 20);
+
+        csv_batch_reader(const csv_batch_reader &) = delete;
+
+        csv_batch_reader &operator=(const csv_batch_reader &) = delete;
+
+        /**
+         * @brief Stop the background thread, the remaining batches are dropped.
+         */
+        ~csv_batch_reader();
+
+        /**
+         * @brief Get the next batch, waiting for it if needed.
+         *
+         * The previous batch goes back to the ring, so its pointer must not be used afterwards.
+         *
+         * @return The batch, or nullptr at the end of the file.
+         * @throws std::invalid_argument On a ragged or malformed line (with its line number) unless
+         * options.skipBadLines is set.
+         */
+        const tensor<type> *next();
+
+        /**
+         * @brief Number of columns of every batch.
+         */
+        [[nodiscard]] size_t cols() const { return _cols; }
+
+        /**
+         * @brief Column names, when options.header is set.
+         */
+        [[nodiscard]] const std::vector<std::string> &header() const { return _header; }
+
+        /**
+         * @brief Lines skipped with options.skipBadLines, complete once next() returned nullptr.
+         */
+        [[nodiscard]] const std::vector<csv_issue> &skipped() const { return _skipped; }
+
+    private:
+        /**
+        * @brief Get the next line of the file without its '\n', false at the end of the file.
+        */
+        bool readLine(std::string_view &line);
+
+        void produce(csv_row_parser parser);
+    };
+
+} // tns::io
+
+#endif //MATRIX_CSV_STREAM_H
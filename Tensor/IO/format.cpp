@@ -0,0 +1,334 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+/**
+ * @file format.cpp
+ * @brief Text rendering of tensors for display(), operator<< and heatmap().
+ */
+
+#include "format.h"
+#include "../../Color/color.h"
+#include "../Parallel/thread_pool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace tns::io {
+
+    namespace {
+
+        // Longest escape sequence of the color scale
+        constexpr size_t maxColorLength() {
+            size_t length = 0;
+            for (std::string_view code : color::SCALE) {
+                length = std::max(length, code.size());
+            }
+            return length;
+        }
+
+        // Append text at used, growing out when the reservation was too small
+        void put(std::string &out, size_t &used, std::string_view text) {
+            if (used + text.size() > out.size()) {
+                out.resize(std::max(out.size() * 2, used + text.size()));
+            }
+            std::copy(text.begin(), text.end(), out.begin() + static_cast<std::ptrdiff_t>(used));
+            used += text.size();
+        }
+
+        void putSpaces(std::string &out, size_t &used, size_t count) {
+            if (used + count > out.size()) {
+                out.resize(std::max(out.size() * 2, used + count));
+            }
+            std::fill_n(out.begin() + static_cast<std::ptrdiff_t>(used), count, ' ');
+            used += count;
+        }
+
+        // Fixed notation of value through integers, or nullptr when value * 10^precision is too large or too close to
+        // a rounding tie to be sure the digits match std::to_chars. The product is off by less than 2^-13 below 2^40.
+        template<typename type>
+        char *fixedFast(char *first, type value, int precision) {
+            static constexpr double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+            if (precision > 9) {
+                return nullptr;
+            }
+
+            const double scaled = std::abs(static_cast<double>(value)) * pow10[precision];
+            if (!(scaled < 0x1p40)) {
+                return nullptr;
+            }
+            const auto whole = static_cast<uint64_t>(scaled);
+            const double fraction = scaled - static_cast<double>(whole);
+            if (std::abs(fraction - 0.5) < 1e-3) {
+                return nullptr;
+            }
+
+            const auto power = static_cast<uint64_t>(pow10[precision]);
+            const uint64_t units = whole + (fraction > 0.5);
+            char *p = first;
+            if (std::signbit(value)) {
+                *p++ = '-';
+            }
+            p = std::to_chars(p, p + 24, units / power).ptr;
+            if (precision > 0) {
+                *p++ = '.';
+                uint64_t fraction = units % power;
+                for (int k = precision - 1; k >= 0; --k) {
+                    p[k] = static_cast<char>('0' + fraction % 10);
+                    fraction /= 10;
+                }
+                p += precision;
+            }
+            return p;
+        }
+
+        // Text of value in fixed notation, in number or, when it does not fit, in wide
+        template<typename type>
+        std::string_view formatNumber(type value, int precision, char (&number)[352], std::string &wide) {
+            if constexpr (std::is_integral_v<type>) {
+                const auto result = std::to_chars(number, number + sizeof(number), value);
+                return {number, static_cast<size_t>(result.ptr - number)};
+            } else {
+                if (const char *end = fixedFast(number, value, precision)) {
+                    return {number, static_cast<size_t>(end - number)};
+                }
+                auto result = std::to_chars(number, number + sizeof(number), value, std::chars_format::fixed,
+                                            precision);
+                if (result.ec == std::errc()) {
+                    return {number, static_cast<size_t>(result.ptr - number)};
+                }
+                wide.resize(400 + static_cast<size_t>(precision));
+                result = std::to_chars(wide.data(), wide.data() + wide.size(), value, std::chars_format::fixed,
+                                       precision);
+                return {wide.data(), static_cast<size_t>(result.ptr - wide.data())};
+            }
+        }
+
+
+        // Level of value on the color scale of [min, min + 7 * delta], like std::round (a library call) would give
+        std::string_view scaleColor(double index) {
+            const int whole = (index >= 0 && index < 8) ? static_cast<int>(index) : -1;
+            return color::scale((whole >= 0 && index - whole >= 0.5) ? whole + 1 : whole);
+        }
+
+        // Indices shown along an axis of count elements: all of them, or edgeItems at each end around a gap (npos)
+        std::vector<size_t> shownIndices(size_t count, size_t edgeItems, bool summarize) {
+            std::vector<size_t> indices;
+            if (!summarize || count <= 2 * edgeItems) {
+                indices.resize(count);
+                std::iota(indices.begin(), indices.end(), size_t(0));
+                return indices;
+            }
+            for (size_t k = 0; k < edgeItems; ++k) {
+                indices.push_back(k);
+            }
+            indices.push_back(std::string::npos);
+            for (size_t k = count - edgeItems; k < count; ++k) {
+                indices.push_back(k);
+            }
+            return indices;
+        }
+
+        // Sum or maximum of the n elements p[k * stride], in four independent accumulators
+        template<heatmap_mode Mode, typename type>
+        double reduceRun(const type *p, size_t n, size_t stride) {
+            auto combine = [](double a, double b) { return (Mode == heatmap_mode::max) ? std::max(a, b) : a + b; };
+            double acc[4];
+            std::fill_n(acc, 4, (Mode == heatmap_mode::max) ? -std::numeric_limits<double>::infinity() : 0.0);
+
+            size_t k = 0;
+            for (; k + 4 <= n; k += 4) {
+                for (size_t l = 0; l < 4; ++l) {
+                    acc[l] = combine(acc[l], static_cast<double>(p[(k + l) * stride]));
+                }
+            }
+            for (; k < n; ++k) {
+                acc[0] = combine(acc[0], static_cast<double>(p[k * stride]));
+            }
+            return combine(combine(acc[0], acc[1]), combine(acc[2], acc[3]));
+        }
+
+        const char *modeName(heatmap_mode mode) {
+            return (mode == heatmap_mode::max) ? "max" : "mean";
+        }
+    }
+
+    template<typename type>
+    void printTensor(std::ostream &out, const type *data, size_t rows, size_t cols, size_t rowStride,
+                     size_t colStride, type min, type max, int precision, bool color, size_t threshold,
+                     size_t edgeItems) {
+        precision = std::is_integral_v<type> ? 0 : std::max(precision, 0);
+        const float delta = (max - min > 0) ? (max - min) / 7.0 : 1.0;
+
+        // including space(2), sign-(1), decimal dot(0 or 1)
+        int padding = std::is_integral_v<type> ? 3 : 4;
+        padding -= (min > 0);
+        const type numBeforeDot = std::max(std::abs(max), std::abs(min));
+        const int digits = static_cast<int>(std::log10(std::max<double>(numBeforeDot, 1)) + 1); // number before dot
+        const size_t width = static_cast<size_t>(digits + padding + precision);
+
+        const bool summarize = rows * cols > threshold;
+        const std::vector<size_t> shownRows = shownIndices(rows, edgeItems, summarize);
+        const std::vector<size_t> shownCols = shownIndices(cols, edgeItems, summarize);
+
+        const size_t cell = width + (color ? maxColorLength() + color::RESET.size() : 0);
+        std::string text(shownRows.size() * (shownCols.size() * std::max<size_t>(cell, 5) + 1), '\0');
+        size_t used = 0;
+
+        // Fixed notation of the largest double has 309 digits
+        char number[352];
+        std::string wide;
+
+        for (const size_t i : shownRows) {
+            if (i == std::string::npos) {
+                putSpaces(text, used, (width > 3) ? width - 3 : 0);
+                put(text, used, "...\n");
+                continue;
+            }
+
+            const type *row = data + i * rowStride;
+            for (const size_t j : shownCols) {
+                if (j == std::string::npos) {
+                    put(text, used, "  ...");
+                    continue;
+                }
+                const type value = row[j * colStride];
+
+                std::string_view level;
+                if (color) {
+                    level = scaleColor((value - min) / delta);
+                    put(text, used, level);
+                }
+
+                const std::string_view digitsText = formatNumber(value, precision, number, wide);
+                if (digitsText.size() < width) {
+                    putSpaces(text, used, width - digitsText.size());
+                }
+                put(text, used, digitsText);
+                if (!level.empty()) {
+                    put(text, used, color::RESET);
+                }
+            }
+            put(text, used, "\n");
+        }
+
+        out.write(text.data(), static_cast<std::streamsize>(used));
+    }
+
+    template<typename type>
+    void printHeatmap(std::ostream &out, const type *data, size_t rows, size_t cols, size_t rowStride,
+                      size_t colStride, size_t height, size_t width, heatmap_mode mode) {
+        height = std::min(height, rows);
+        width = std::min(width, cols);
+        if (height == 0 || width == 0) {
+            out << rows << " x " << cols << '\n';
+            return;
+        }
+
+        // Block (r, c) covers rows [r * rows / height, (r + 1) * rows / height) and the matching columns
+        std::vector<size_t> colBounds(width + 1);
+        for (size_t c = 0; c <= width; ++c) {
+            colBounds[c] = c * cols / width;
+        }
+
+        std::vector<double> blocks(height * width);
+        auto reduceBands = [&]<heatmap_mode Mode>(size_t begin, size_t end) {
+            for (size_t r = begin; r < end; ++r) {
+                double *cells = blocks.data() + r * width;
+                const size_t first = r * rows / height, last = (r + 1) * rows / height;
+                std::fill_n(cells, width, (Mode == heatmap_mode::max) ? -std::numeric_limits<double>::infinity() : 0);
+
+                for (size_t i = first; i < last; ++i) {
+                    const type *row = data + i * rowStride;
+                    for (size_t c = 0; c < width; ++c) {
+                        const double run = reduceRun<Mode>(row + colBounds[c] * colStride,
+                                                           colBounds[c + 1] - colBounds[c], colStride);
+                        cells[c] = (Mode == heatmap_mode::max) ? std::max(cells[c], run) : cells[c] + run;
+                    }
+                }
+
+                if constexpr (Mode == heatmap_mode::mean) {
+                    for (size_t c = 0; c < width; ++c) {
+                        cells[c] /= static_cast<double>((last - first) * (colBounds[c + 1] - colBounds[c]));
+                    }
+                }
+            }
+        };
+        auto reduceBand = [&](size_t begin, size_t end) {
+            if (mode == heatmap_mode::max) {
+                reduceBands.template operator()<heatmap_mode::max>(begin, end);
+            } else {
+                reduceBands.template operator()<heatmap_mode::mean>(begin, end);
+            }
+        };
+        if (rows * cols < parallel::threshold() || parallel::threadCount() <= 1) {
+            reduceBand(0, height);
+        } else {
+            parallel::parallelFor(0, height, 1, reduceBand);
+        }
+
+        const auto [low, high] = std::minmax_element(blocks.begin(), blocks.end());
+        const double min = *low, max = *high;
+        const double delta = (max - min > 0) ? (max - min) / 7.0 : 1.0;
+
+        // One block character (3 bytes in UTF-8) per cell
+        constexpr std::string_view block = "\u2588";
+        std::string text(height * (width * (maxColorLength() + block.size() + color::RESET.size()) + 1), '\0');
+        size_t used = 0;
+        for (size_t r = 0; r < height; ++r) {
+            // A color is written only where the level changes
+            std::string_view current;
+            for (size_t c = 0; c < width; ++c) {
+                const std::string_view level = scaleColor((blocks[r * width + c] - min) / delta);
+                if (level != current) {
+                    put(text, used, level.empty() ? color::RESET : level);
+                    current = level;
+                }
+                put(text, used, block);
+            }
+            if (!current.empty()) {
+                put(text, used, color::RESET);
+            }
+            put(text, used, "\n");
+        }
+
+        char number[352];
+        std::string wide;
+        std::string legend = std::to_string(rows) + " x " + std::to_string(cols) + " in " + std::to_string(height)
+                             + " x " + std::to_string(width) + " blocks (" + modeName(mode) + "), from ";
+        legend += formatNumber(min, 2, number, wide);
+        legend += " to ";
+        legend += formatNumber(max, 2, number, wide);
+        legend += '\n';
+        put(text, used, legend);
+
+        out.write(text.data(), static_cast<std::streamsize>(used));
+    }
+
+    template void printTensor<int>(std::ostream &, const int *, size_t, size_t, size_t, size_t, int, int, int, bool,
+                                   size_t, size_t);
+
+    template void printTensor<double>(std::ostream &, const double *, size_t, size_t, size_t, size_t, double, double,
+                                      int, bool, size_t, size_t);
+
+    template void printTensor<float>(std::ostream &, const float *, size_t, size_t, size_t, size_t, float, float,
+                                     int, bool, size_t, size_t);
+
+    template void printHeatmap<int>(std::ostream &, const int *, size_t, size_t, size_t, size_t, size_t, size_t,
+                                    heatmap_mode);
+
+    template void printHeatmap<double>(std::ostream &, const double *, size_t, size_t, size_t, size_t, size_t, size_t,
+                                       heatmap_mode);
+
+    template void printHeatmap<float>(std::ostream &, const float *, size_t, size_t, size_t, size_t, size_t, size_t,
+                                      heatmap_mode);
+
+} // tns::io
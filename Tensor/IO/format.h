@@ -0,0 +1,67 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_FORMAT_H
+#define MATRIX_FORMAT_H
+
+#include <cstddef>
+#include <ostream>
+
+namespace tns::io {
+
+    /**
+     * @brief How printHeatmap() reduces each block of elements to one cell.
+     */
+    enum class heatmap_mode {
+        mean,
+        max
+    };
+
+    /**
+     * @brief Print a strided matrix as an aligned, optionally colored table, as display() and operator<< do.
+     *
+     * @details
+     * Every cell is right-aligned to one width, wide enough for the largest magnitude, its sign and precision
+     * decimals. With color set, the range [min, max] is cut into 7 levels shown with color::scale(). The whole table
+     * is formatted with std::to_chars into one preallocated buffer and written to out once; the state of out
+     * (precision, flags, width) is neither used nor modified.
+     *
+     * When the matrix has more than threshold elements it is summarized like NumPy does: only the first and last
+     * edgeItems rows and columns are printed, around a "..." line and a "..." column.
+     *
+     * @param out The stream to write to.
+     * @param data Element (i, j) is data[i * rowStride + j * colStride].
+     * @param min Smallest element, sets the width and the bottom of the color scale.
+     * @param max Largest element, sets the width and the top of the color scale.
+     * @param precision Number of decimals in fixed notation, ignored for integers.
+     * @param color Whether to color each cell by its level.
+     * @param threshold Largest number of elements printed in full.
+     * @param edgeItems Number of rows and columns printed at each end of a summarized matrix.
+     */
+    template<typename type>
+    void printTensor(std::ostream &out, const type *data, size_t rows, size_t cols, size_t rowStride,
+                     size_t colStride, type min, type max, int precision, bool color, size_t threshold = 1000,
+                     size_t edgeItems = 3);
+
+    /**
+     * @brief Print a strided matrix as a colored grid of at most height x width cells, one block per cell.
+     *
+     * @details
+     * The matrix is cut into height x width blocks of nearly equal size, each reduced to its mean or its largest
+     * element; bands of blocks are reduced in parallel. Each cell is a block character colored with the 7-level
+     * scale of color::scale() over the range of the reduced values, which a last line gives with the shape.
+     *
+     * @param out The stream to write to.
+     * @param data Element (i, j) is data[i * rowStride + j * colStride].
+     * @param height Largest number of lines of the grid.
+     * @param width Largest number of columns of the grid.
+     * @param mode Reduction of each block.
+     */
+    template<typename type>
+    void printHeatmap(std::ostream &out, const type *data, size_t rows, size_t cols, size_t rowStride,
+                      size_t colStride, size_t height, size_t width, heatmap_mode mode);
+
+} // tns::io
+
+#endif //MATRIX_FORMAT_H
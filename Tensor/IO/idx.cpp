@@ -0,0 +1,176 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+/**
+ * @file idx.cpp
+ * @brief IDX reader: big-endian header, fused byte conversion through the SIMD kernels.
+ */
+
+#include "idx.h"
+#include "../Kernel/simd.h"
+#include "../Parallel/thread_pool.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace tns::io {
+
+    namespace {
+
+        size_t elementSize(unsigned char type) {
+            switch (type) {
+                case 0x08:
+                case 0x09:
+                    return 1;
+                case 0x0B:
+                    return 2;
+                case 0x0C:
+                case 0x0D:
+                    return 4;
+                case 0x0E:
+                    return 8;
+                default:
+                    return 0;
+            }
+        }
+
+        template<typename integer>
+        integer readBigEndian(const unsigned char *p) {
+            integer value = 0;
+            for (size_t k = 0; k < sizeof(integer); ++k) {
+                value = static_cast<integer>((value << 8) | p[k]);
+            }
+            return value;
+        }
+
+        // Element k of an array of the given IDX type
+        double element(const unsigned char *data, unsigned char type, size_t k) {
+            switch (type) {
+                case 0x08:
+                    return data[k];
+                case 0x09:
+                    return static_cast<int8_t>(data[k]);
+                case 0x0B:
+                    return static_cast<int16_t>(readBigEndian<uint16_t>(data + 2 * k));
+                case 0x0C:
+                    return static_cast<int32_t>(readBigEndian<uint32_t>(data + 4 * k));
+                case 0x0D:
+                    return std::bit_cast<float>(readBigEndian<uint32_t>(data + 4 * k));
+                default:
+                    return std::bit_cast<double>(readBigEndian<uint64_t>(data + 8 * k));
+            }
+        }
+
+    }
+
+    idx_file::idx_file(const std::string &filename) : _file(std::make_shared<mapped_file>(filename)) {
+        const auto *data = reinterpret_cast<const unsigned char *>(_file->data());
+        const size_t size = _file->size();
+
+        if (size < 4 || data[0] != 0 || data[1] != 0 || elementSize(data[2]) == 0 || data[3] == 0) {
+            throw std::invalid_argument("\nNot an IDX file (tns::io::idx_file): " + filename);
+        }
+        _type = data[2];
+        _offset = 4 + 4 * size_t(data[3]);
+        if (size < _offset) {
+            throw std::invalid_argument("\nTruncated IDX file (tns::io::idx_file): " + filename);
+        }
+
+        size_t elements = 1;
+        for (size_t d = 0; d < data[3]; ++d) {
+            _dims.push_back(readBigEndian<uint32_t>(data + 4 + 4 * d));
+            elements *= _dims.back();
+        }
+        if ((size - _offset) / elementSize(_type) < elements) {
+            throw std::invalid_argument("\nTruncated IDX file (tns::io::idx_file): " + filename);
+        }
+    }
+
+    size_t idx_file::sampleSize() const {
+        size_t size = 1;
+        for (size_t d = 1; d < _dims.size(); ++d) {
+            size *= _dims[d];
+        }
+        return size;
+    }
+
+    template<typename type>
+    tensor<type> idx_file::batch(size_t first, size_t count, type scale, type shift) const {
+        count = clamp(first, count);
+        const size_t n = count * sampleSize();
+        const auto *data = reinterpret_cast<const unsigned char *>(_file->data()) + _offset;
+
+        tensor<type> output(count, sampleSize());
+        type *out = output.data().data();
+
+        if (_type == 0x08) {
+            const auto scaleBytes = simd::kernels<type>().scaleBytes;
+            const unsigned char *bytes = data + first * sampleSize();
+            parallel::forEachChunk(n, [&](size_t begin, size_t end) {
+                scaleBytes(bytes + begin, scale, shift, out + begin, end - begin);
+            });
+        } else {
+            const size_t offset = first * sampleSize();
+            parallel::forEachChunk(n, [&](size_t begin, size_t end) {
+                for (size_t k = begin; k < end; ++k) {
+                    out[k] = static_cast<type>(element(data, _type, offset + k) * scale + shift);
+                }
+            });
+        }
+
+        return output;
+    }
+
+    template<typename type>
+    tensor<type> idx_file::oneHot(size_t first, size_t count, size_t classes) const {
+        if (sampleSize() != 1 || _type == 0x0D || _type == 0x0E) {
+            throw std::invalid_argument("\nOne-hot encoding of samples that are not integer labels "
+                                        "(tns::io::idx_file::oneHot())");
+        }
+        count = clamp(first, count);
+        const auto *data = reinterpret_cast<const unsigned char *>(_file->data()) + _offset;
+
+        tensor<type> output(count, classes, type(0));
+        type *out = output.data().data();
+        for (size_t i = 0; i < count; ++i) {
+            const double label = element(data, _type, first + i);
+            if (label < 0 || label >= static_cast<double>(classes)) {
+                std::ostringstream message;
+                message << "\nLabel " << label << " of sample " << first + i << " not in [0, " << classes
+                        << ") (tns::io::idx_file::oneHot())";
+                throw std::out_of_range(message.str());
+            }
+            out[i * classes + static_cast<size_t>(label)] = type(1);
+        }
+
+        return output;
+    }
+
+    size_t idx_file::clamp(size_t first, size_t count) const {
+        if (first >= this->count()) {
+            std::ostringstream message;
+            message << "\nSample " << first << " out of range (tns::io::idx_file): the file has " << this->count()
+                    << " samples";
+            throw std::out_of_range(message.str());
+        }
+        return std::min(count, this->count() - first);
+    }
+
+    template tensor<int> idx_file::batch<int>(size_t, size_t, int, int) const;
+
+    template tensor<double> idx_file::batch<double>(size_t, size_t, double, double) const;
+
+    template tensor<float> idx_file::batch<float>(size_t, size_t, float, float) const;
+
+    template tensor<int> idx_file::oneHot<int>(size_t, size_t, size_t) const;
+
+    template tensor<double> idx_file::oneHot<double>(size_t, size_t, size_t) const;
+
+    template tensor<float> idx_file::oneHot<float>(size_t, size_t, size_t) const;
+
+} // tns::io
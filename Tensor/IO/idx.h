@@ -0,0 +1,92 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_IDX_H
+#define MATRIX_IDX_H
+
+#include "mapped_file.h"
+#include "../tensor.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tns::io {
+
+    /**
+     * @brief An IDX file (the format of the MNIST images and labels) mapped in memory.
+     *
+     * @details
+     * The file holds an array of samples: the first dimension counts them, the others give their shape (28 x 28 for
+     * the MNIST images, none for the labels). Batches are tensors with one sample per row, flattened. Unsigned byte
+     * files are converted with the SIMD kernel scaleBytes, in parallel on large batches, so scaling and normalizing
+     * cost no extra pass; other element types are byte-swapped from big-endian and converted.
+     *
+     * @code
+     * tns::io::idx_file images("train-images-idx3-ubyte"), labels("train-labels-idx1-ubyte");
+     * // Pixels in [0, 1], then standardized with the MNIST mean and standard deviation
+     * const float scale = 1.0f / 255 / 0.3081f, shift = -0.1307f / 0.3081f;
+     * for (size_t first = 0; first < images.count(); first += 64) {
+     *     tns::tensor<float> X = images.batch<float>(first, 64, scale, shift); // 64 x 784
+     *     tns::tensor<float> Y = labels.oneHot<float>(first, 64, 10);          // 64 x 10
+     * }
+     * @endcode
+     */
+    class idx_file {
+        std::shared_ptr<mapped_file> _file;
+        unsigned char _type = 0;   // 0x08 ubyte, 0x09 byte, 0x0B short, 0x0C int, 0x0D float, 0x0E double
+        std::vector<size_t> _dims;
+        size_t _offset = 0;        // Offset of the first element
+
+    public:
+        /**
+         * @brief Map filename and read its header.
+         *
+         * @throws std::runtime_error If the file cannot be opened.
+         * @throws std::invalid_argument If it is not an IDX file or is truncated.
+         */
+        explicit idx_file(const std::string &filename);
+
+        /**
+         * @brief The dimensions of the array, the first one is the number of samples.
+         */
+        [[nodiscard]] const std::vector<size_t> &dims() const { return _dims; }
+
+        /**
+         * @brief Number of samples.
+         */
+        [[nodiscard]] size_t count() const { return _dims.empty() ? 0 : _dims[0]; }
+
+        /**
+         * @brief Number of elements of one sample, the columns of a batch.
+         */
+        [[nodiscard]] size_t sampleSize() const;
+
+        /**
+         * @brief Get samples [first, first + count) as a (count x sampleSize()) tensor of value * scale + shift.
+         *
+         * count is clamped to the end of the file.
+         *
+         * @throws std::out_of_range If first is past the last sample.
+         */
+        template<typename type>
+        tensor<type> batch(size_t first, size_t count, type scale = 1, type shift = 0) const;
+
+        /**
+         * @brief Get labels [first, first + count) one-hot encoded, as a (count x classes) tensor.
+         *
+         * @throws std::out_of_range If first is past the last sample, or a label is not in [0, classes).
+         * @throws std::invalid_argument If the samples are not single integers.
+         */
+        template<typename type>
+        tensor<type> oneHot(size_t first, size_t count, size_t classes) const;
+
+    private:
+        size_t clamp(size_t first, size_t count) const;
+    };
+
+} // tns::io
+
+#endif //MATRIX_IDX_H
@@ -0,0 +1,108 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#include "mapped_file.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TNS_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define TNS_HAS_MMAP 0
+#endif
+
+namespace tns::io {
+
+    mapped_file::mapped_file(const std::string &filename, bool sequential, bool copyOnWrite)
+            : _copyOnWrite(copyOnWrite) {
+#if TNS_HAS_MMAP
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("\nError opening file (tns::io::mapped_file): " + filename);
+        }
+
+        struct stat info{};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("\nError reading file size (tns::io::mapped_file): " + filename);
+        }
+
+        _size = static_cast<size_t>(info.st_size);
+        if (_size != 0) {
+            const int protection = copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+            void *address = ::mmap(nullptr, _size, protection, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("\nError mapping file (tns::io::mapped_file): " + filename);
+            }
+            if (sequential) {
+                ::madvise(address, _size, MADV_SEQUENTIAL);
+            }
+            _data = static_cast<const char *>(address);
+            _mapped = true;
+        }
+        // The mapping stays valid after the descriptor is closed
+        ::close(fd);
+#else
+        (void) sequential;
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            throw std::runtime_error("\nError opening file (tns::io::mapped_file): " + filename);
+        }
+
+        _size = static_cast<size_t>(file.tellg());
+        if (_size != 0) {
+            char *buffer = new char[_size];
+            file.seekg(0);
+            file.read(buffer, static_cast<std::streamsize>(_size));
+            _data = buffer;
+        }
+#endif
+    }
+
+    mapped_file::mapped_file(mapped_file &&other) noexcept
+            : _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0)),
+              _mapped(std::exchange(other._mapped, false)), _copyOnWrite(std::exchange(other._copyOnWrite, false)) {}
+
+    mapped_file &mapped_file::operator=(mapped_file &&other) noexcept {
+        if (this != &other) {
+            release();
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+            _mapped = std::exchange(other._mapped, false);
+            _copyOnWrite = std::exchange(other._copyOnWrite, false);
+        }
+        return *this;
+    }
+
+    mapped_file::~mapped_file() {
+        release();
+    }
+
+    void mapped_file::release() {
+        if (_data == nullptr) {
+            return;
+        }
+#if TNS_HAS_MMAP
+        if (_mapped) {
+            ::munmap(const_cast<char *>(_data), _size);
+        } else {
+            delete[] _data;
+        }
+#else
+        delete[] _data;
+#endif
+        _data = nullptr;
+        _size = 0;
+        _mapped = false;
+        _copyOnWrite = false;
+    }
+
+} // tns::io
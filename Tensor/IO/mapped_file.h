@@ -0,0 +1,73 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_MAPPED_FILE_H
+#define MATRIX_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace tns::io {
+
+    /**
+     * @brief Read-only view of a whole file.
+     *
+     * @details
+     * On POSIX systems the file is memory-mapped, so opening is O(1) and pages are read on first access. Elsewhere
+     * the file is read into a heap buffer. Move-only; the mapping is released by the destructor.
+     */
+    class mapped_file {
+        const char *_data = nullptr;
+        size_t _size = 0;
+        bool _mapped = false;      // false: _data was allocated with new[]
+        bool _copyOnWrite = false; // Pages are writable and private to the process
+
+    public:
+        mapped_file() = default;
+
+        /**
+         * @brief Map filename.
+         *
+         * @param filename Path of the file.
+         * @param sequential Hint the kernel that the file is read front to back.
+         * @param copyOnWrite Map the pages writable and private: a write copies the page it touches and never
+         * reaches the file.
+         * @throws std::runtime_error If the file cannot be opened or mapped.
+         */
+        explicit mapped_file(const std::string &filename, bool sequential = true, bool copyOnWrite = false);
+
+        mapped_file(const mapped_file &) = delete;
+
+        mapped_file &operator=(const mapped_file &) = delete;
+
+        mapped_file(mapped_file &&other) noexcept;
+
+        mapped_file &operator=(mapped_file &&other) noexcept;
+
+        ~mapped_file();
+
+        [[nodiscard]] const char *data() const { return _data; }
+
+        [[nodiscard]] size_t size() const { return _size; }
+
+        [[nodiscard]] std::string_view view() const { return {_data, _size}; }
+
+        /**
+         * @brief Get a writable pointer to the content, nullptr unless opened with copyOnWrite.
+         */
+        [[nodiscard]] char *writableData() const { return _copyOnWrite ? const_cast<char *>(_data) : nullptr; }
+
+        /**
+         * @brief Check whether the file is memory-mapped (true) or was read into memory (false).
+         */
+        [[nodiscard]] bool mapped() const { return _mapped; }
+
+    private:
+        void release();
+    };
+
+} // tns::io
+
+#endif //MATRIX_MAPPED_FILE_H
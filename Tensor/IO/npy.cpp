@@ -0,0 +1,235 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+/**
+ * @file npy.cpp
+ * @brief NumPy .npy header parsing and element conversion.
+ *
+ * @details
+ * The format is described in numpy/lib/format.py: the magic string "\x93NUMPY", a version, the length of the
+ * header, then a Python dictionary literal with the keys 'descr', 'fortran_order' and 'shape', padded with spaces
+ * and ended by '\n'.
+ */
+
+#include "npy.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace tns::io {
+
+    namespace {
+
+        constexpr std::string_view MAGIC = "\x93NUMPY";
+
+        constexpr char nativeOrder = (std::endian::native == std::endian::little) ? '<' : '>';
+
+        [[noreturn]] void invalidHeader(const std::string &reason) {
+            throw std::invalid_argument("\nInvalid .npy header (tns::io::parseNpyHeader()): " + reason);
+        }
+
+        // Value of 'key' in the dictionary, up to the next ',' or '}' outside parentheses
+        std::string_view dictValue(std::string_view dict, std::string_view key) {
+            size_t position = std::string_view::npos;
+            for (const char quote: {'\'', '"'}) {
+                const std::string quoted = quote + std::string(key) + quote;
+                position = dict.find(quoted);
+                if (position != std::string_view::npos) {
+                    position += quoted.size();
+                    break;
+                }
+            }
+            if (position == std::string_view::npos || (position = dict.find(':', position)) == std::string_view::npos) {
+                invalidHeader("missing '" + std::string(key) + "'");
+            }
+
+            size_t end = ++position;
+            for (int depth = 0; end < dict.size(); ++end) {
+                const char c = dict[end];
+                if (c == '(') ++depth;
+                else if (c == ')') --depth;
+                else if ((c == ',' || c == '}') && depth == 0) break;
+            }
+
+            std::string_view value = dict.substr(position, end - position);
+            while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+            while (!value.empty() && value.back() == ' ') value.remove_suffix(1);
+            return value;
+        }
+
+        uint64_t readLittleEndian(const char *p, size_t bytes) {
+            uint64_t value = 0;
+            for (size_t k = bytes; k-- > 0;) {
+                value = (value << 8) | static_cast<unsigned char>(p[k]);
+            }
+            return value;
+        }
+
+        template<typename source, typename type>
+        void convertFrom(const char *bytes, type *out, size_t count, bool swap) {
+            char element[sizeof(source)];
+            for (size_t k = 0; k < count; ++k) {
+                std::memcpy(element, bytes + k * sizeof(source), sizeof(source));
+                if (swap) {
+                    std::reverse(element, element + sizeof(source));
+                }
+                source value;
+                std::memcpy(&value, element, sizeof(source));
+                out[k] = static_cast<type>(value);
+            }
+        }
+
+    }
+
+    size_t npy_header::itemSize() const {
+        size_t size = 0;
+        if (descr.size() < 3) {
+            return 0;
+        }
+        const auto [end, error] = std::from_chars(descr.data() + 2, descr.data() + descr.size(), size);
+        return (error == std::errc()) ? size : 0;
+    }
+
+    size_t npy_header::count() const {
+        size_t count = 1;
+        for (size_t extent: shape) {
+            count *= extent;
+        }
+        return count;
+    }
+
+    npy_header parseNpyHeader(std::string_view file) {
+        if (file.size() < 10 || file.substr(0, MAGIC.size()) != MAGIC) {
+            invalidHeader("not a .npy file");
+        }
+
+        const int major = static_cast<unsigned char>(file[6]);
+        if (major < 1 || major > 3) {
+            invalidHeader("unsupported version " + std::to_string(major));
+        }
+        const size_t lengthBytes = (major == 1) ? 2 : 4;
+        const size_t length = readLittleEndian(file.data() + 8, lengthBytes);
+        const size_t begin = 8 + lengthBytes;
+        if (file.size() < begin + length) {
+            invalidHeader("truncated header");
+        }
+        const std::string_view dict = file.substr(begin, length);
+
+        npy_header header;
+        header.dataOffset = begin + length;
+
+        std::string_view descr = dictValue(dict, "descr");
+        if (descr.size() < 2 || (descr.front() != '\'' && descr.front() != '"') || descr.back() != descr.front()) {
+            invalidHeader("'descr' is not a string: " + std::string(descr));
+        }
+        header.descr = descr.substr(1, descr.size() - 2);
+
+        const std::string_view order = dictValue(dict, "fortran_order");
+        if (order != "True" && order != "False") {
+            invalidHeader("'fortran_order' is not a boolean: " + std::string(order));
+        }
+        header.fortranOrder = (order == "True");
+
+        std::string_view shape = dictValue(dict, "shape");
+        if (shape.size() < 2 || shape.front() != '(' || shape.back() != ')') {
+            invalidHeader("'shape' is not a tuple: " + std::string(shape));
+        }
+        shape = shape.substr(1, shape.size() - 2);
+        for (const char *p = shape.data(), *end = shape.data() + shape.size(); p < end;) {
+            while (p < end && (*p == ' ' || *p == ',')) {
+                ++p;
+            }
+            if (p == end) {
+                break;
+            }
+            size_t extent;
+            const auto [next, error] = std::from_chars(p, end, extent);
+            if (error != std::errc()) {
+                invalidHeader("'shape' is not a tuple of integers: (" + std::string(shape) + ")");
+            }
+            header.shape.push_back(extent);
+            p = next;
+            if (p < end && *p == 'L') {
+                ++p; // Python 2 long
+            }
+        }
+
+        return header;
+    }
+
+    std::string formatNpyHeader(std::string_view descr, const std::vector<size_t> &shape, bool fortranOrder) {
+        std::ostringstream dict;
+        dict << "{'descr': '" << descr << "', 'fortran_order': " << (fortranOrder ? "True" : "False")
+             << ", 'shape': (";
+        for (size_t k = 0; k < shape.size(); ++k) {
+            dict << shape[k] << ((shape.size() == 1 || k + 1 < shape.size()) ? "," : "");
+            if (k + 1 < shape.size()) {
+                dict << ' ';
+            }
+        }
+        dict << "), }";
+
+        // Magic, version 1.0, 2-byte length, the dictionary, spaces and '\n' up to a multiple of 64
+        std::string text = dict.str();
+        const size_t total = (MAGIC.size() + 4 + text.size() + 1 + 63) / 64 * 64;
+        text.append(total - MAGIC.size() - 4 - text.size() - 1, ' ');
+        text.push_back('\n');
+
+        const size_t length = text.size();
+        std::string header(MAGIC);
+        header.push_back('\x01');
+        header.push_back('\x00');
+        header.push_back(static_cast<char>(length & 0xFF));
+        header.push_back(static_cast<char>(length >> 8));
+        return header + text;
+    }
+
+    template<typename type>
+    std::string npyDescr() {
+        const char kind = std::is_floating_point_v<type> ? 'f' : (std::is_signed_v<type> ? 'i' : 'u');
+        return std::string{nativeOrder, kind} + std::to_string(sizeof(type));
+    }
+
+    template<typename type>
+    void convertNpy(std::string_view descr, const char *source, type *out, size_t count) {
+        if (descr.size() < 3) {
+            throw std::invalid_argument("\nUnsupported .npy descr (tns::io::convertNpy()): " + std::string(descr));
+        }
+        const char order = descr[0], kind = descr[1];
+        const std::string_view size = descr.substr(2);
+        const bool swap = (order == '<' || order == '>') && order != nativeOrder;
+
+        if (kind == 'f' && size == "4") return convertFrom<float>(source, out, count, swap);
+        if (kind == 'f' && size == "8") return convertFrom<double>(source, out, count, swap);
+        if (kind == 'i' && size == "1") return convertFrom<int8_t>(source, out, count, swap);
+        if (kind == 'i' && size == "2") return convertFrom<int16_t>(source, out, count, swap);
+        if (kind == 'i' && size == "4") return convertFrom<int32_t>(source, out, count, swap);
+        if (kind == 'i' && size == "8") return convertFrom<int64_t>(source, out, count, swap);
+        if (kind == 'u' && size == "1") return convertFrom<uint8_t>(source, out, count, swap);
+        if (kind == 'u' && size == "2") return convertFrom<uint16_t>(source, out, count, swap);
+        if (kind == 'u' && size == "4") return convertFrom<uint32_t>(source, out, count, swap);
+        if (kind == 'u' && size == "8") return convertFrom<uint64_t>(source, out, count, swap);
+        if (kind == 'b' && size == "1") return convertFrom<bool>(source, out, count, swap);
+
+        throw std::invalid_argument("\nUnsupported .npy descr (tns::io::convertNpy()): " + std::string(descr));
+    }
+
+    template std::string npyDescr<int>();
+
+    template std::string npyDescr<double>();
+
+    template std::string npyDescr<float>();
+
+    template void convertNpy<int>(std::string_view, const char *, int *, size_t);
+
+    template void convertNpy<double>(std::string_view, const char *, double *, size_t);
+
+    template void convertNpy<float>(std::string_view, const char *, float *, size_t);
+
+} // tns::io
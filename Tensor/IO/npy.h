@@ -0,0 +1,66 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_NPY_H
+#define MATRIX_NPY_H
+
+#include <bit>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tns::io {
+
+    /**
+     * @brief The header of a NumPy .npy file.
+     */
+    struct npy_header {
+        std::string descr;          // Element type, e.g. "<f8"
+        bool fortranOrder = false;  // Column-major payload
+        std::vector<size_t> shape;  // Empty for a scalar
+        size_t dataOffset = 0;      // Offset of the payload in the file
+
+        /**
+         * @brief Size of one element in bytes, from descr.
+         */
+        [[nodiscard]] size_t itemSize() const;
+
+        /**
+         * @brief Number of elements, the product of the shape.
+         */
+        [[nodiscard]] size_t count() const;
+    };
+
+    /**
+     * @brief Parse the header of a .npy file (format versions 1.0 to 3.0).
+     *
+     * @param file The beginning of the file, at least up to the end of the header.
+     * @throws std::invalid_argument If the magic string, the version or the header dictionary is invalid.
+     */
+    npy_header parseNpyHeader(std::string_view file);
+
+    /**
+     * @brief Build a version 1.0 header, padded so the payload starts at a multiple of 64 bytes.
+     */
+    std::string formatNpyHeader(std::string_view descr, const std::vector<size_t> &shape, bool fortranOrder = false);
+
+    /**
+     * @brief The descr of type in the byte order of this machine: "<f4", "<f8" or "<i4" on little-endian ones.
+     */
+    template<typename type>
+    std::string npyDescr();
+
+    /**
+     * @brief Convert count elements described by descr (bool, signed or unsigned integer, or floating point of any
+     * byte order) to type.
+     *
+     * @throws std::invalid_argument If descr is not one of these.
+     */
+    template<typename type>
+    void convertNpy(std::string_view descr, const char *source, type *out, size_t count);
+
+} // tns::io
+
+#endif //MATRIX_NPY_H
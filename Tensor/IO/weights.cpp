@@ -0,0 +1,350 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+/**
+ * @file weights.cpp
+ * @brief Weight file format: writer, memory-mapped reader and XXH64 checksum.
+ */
+
+#include "weights.h"
+#include "npy.h"
+
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace tns::io {
+
+    namespace {
+
+        constexpr std::string_view MAGIC{"TNSWGT\0\0", 8};
+        constexpr uint32_t VERSION = 2; // 2: the index stores the full shape instead of (rows, cols)
+        constexpr size_t HEADER_BYTES = 64;
+        constexpr size_t ALIGNMENT = 64;
+
+        constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+        constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+        constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+        constexpr uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+        constexpr uint64_t PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+        template<typename integer>
+        integer readLittleEndian(const unsigned char *p) {
+            integer value;
+            std::memcpy(&value, p, sizeof(integer));
+            if constexpr (std::endian::native == std::endian::big) {
+                value = std::byteswap(value);
+            }
+            return value;
+        }
+
+        template<typename integer>
+        void appendLittleEndian(std::string &out, integer value) {
+            if constexpr (std::endian::native == std::endian::big) {
+                value = std::byteswap(value);
+            }
+            out.append(reinterpret_cast<const char *>(&value), sizeof(integer));
+        }
+
+        uint64_t round(uint64_t accumulator, uint64_t input) {
+            accumulator += input * PRIME_2;
+            return std::rotl(accumulator, 31) * PRIME_1;
+        }
+
+        uint64_t mergeRound(uint64_t hash, uint64_t accumulator) {
+            hash ^= round(0, accumulator);
+            return hash * PRIME_1 + PRIME_4;
+        }
+
+        [[noreturn]] void invalidFile(const std::string &reason) {
+            throw std::invalid_argument("\nInvalid weight file (tns::io::weight_file): " + reason);
+        }
+
+        // Reads the index with bound checks
+        class index_reader {
+            const unsigned char *_p, *_end;
+
+        public:
+            index_reader(const char *data, size_t bytes)
+                    : _p(reinterpret_cast<const unsigned char *>(data)), _end(_p + bytes) {}
+
+            template<typename integer>
+            integer number() {
+                need(sizeof(integer));
+                const auto value = readLittleEndian<integer>(_p);
+                _p += sizeof(integer);
+                return value;
+            }
+
+            std::string text(size_t length) {
+                need(length);
+                std::string value(reinterpret_cast<const char *>(_p), length);
+                _p += length;
+                return value;
+            }
+
+        private:
+            void need(size_t bytes) const {
+                if (static_cast<size_t>(_end - _p) < bytes) {
+                    invalidFile("truncated index");
+                }
+            }
+        };
+
+    }
+
+    uint64_t checksum64(const void *data, size_t bytes, uint64_t seed) {
+        const auto *p = static_cast<const unsigned char *>(data);
+        const unsigned char *end = p + bytes;
+        uint64_t hash;
+
+        if (bytes >= 32) {
+            uint64_t v1 = seed + PRIME_1 + PRIME_2, v2 = seed + PRIME_2, v3 = seed, v4 = seed - PRIME_1;
+            for (; end - p >= 32; p += 32) {
+                v1 = round(v1, readLittleEndian<uint64_t>(p));
+                v2 = round(v2, readLittleEndian<uint64_t>(p + 8));
+                v3 = round(v3, readLittleEndian<uint64_t>(p + 16));
+                v4 = round(v4, readLittleEndian<uint64_t>(p + 24));
+            }
+            hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+            hash = mergeRound(mergeRound(mergeRound(mergeRound(hash, v1), v2), v3), v4);
+        } else {
+            hash = seed + PRIME_5;
+        }
+        hash += bytes;
+
+        for (; end - p >= 8; p += 8) {
+            hash ^= round(0, readLittleEndian<uint64_t>(p));
+            hash = std::rotl(hash, 27) * PRIME_1 + PRIME_4;
+        }
+        if (end - p >= 4) {
+            hash ^= readLittleEndian<uint32_t>(p) * PRIME_1;
+            hash = std::rotl(hash, 23) * PRIME_2 + PRIME_3;
+            p += 4;
+        }
+        for (; p < end; ++p) {
+            hash ^= *p * PRIME_5;
+            hash = std::rotl(hash, 11) * PRIME_1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= PRIME_2;
+        hash ^= hash >> 29;
+        hash *= PRIME_3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+// Writer
+    weight_writer::weight_writer(const std::string &filename)
+            : _filename(filename), _file(filename + ".tmp", std::ios::binary), _offset(HEADER_BYTES) {
+        if (!_file.is_open()) {
+            throw std::runtime_error("\nError creating file (tns::io::weight_writer): " + filename + ".tmp");
+        }
+        // Room for the header, written last
+        const char header[HEADER_BYTES]{};
+        _file.write(header, HEADER_BYTES);
+    }
+
+    weight_writer::~weight_writer() {
+        if (!_closed) {
+            _file.close();
+            std::remove((_filename + ".tmp").c_str());
+        }
+    }
+
+    template<typename type>
+    void weight_writer::add(const std::string &name, const tensor<type> &weights) {
+        if (name.empty() || name.size() > 0xFFFF) {
+            throw std::invalid_argument("\nInvalid tensor name (tns::io::weight_writer::add()): \"" + name + "\"");
+        }
+        for (const weight_entry &entry: _entries) {
+            if (entry.name == name) {
+                throw std::invalid_argument("\nDuplicate tensor name (tns::io::weight_writer::add()): " + name);
+            }
+        }
+
+        const std::span<const type> elements = weights.data();
+        weight_entry entry;
+        entry.name = name;
+        entry.descr = npyDescr<type>();
+        entry.shape = weights.shape();
+        entry.offset = _offset;
+        entry.bytes = elements.size_bytes();
+        entry.checksum = checksum64(elements.data(), elements.size_bytes());
+
+        // Pad the elements to the next multiple of ALIGNMENT
+        const size_t padding = (ALIGNMENT - entry.bytes % ALIGNMENT) % ALIGNMENT;
+        const char zeros[ALIGNMENT]{};
+        _file.write(reinterpret_cast<const char *>(elements.data()), static_cast<std::streamsize>(entry.bytes));
+        _file.write(zeros, static_cast<std::streamsize>(padding));
+        if (!_file) {
+            throw std::runtime_error("\nError writing file (tns::io::weight_writer::add()): " + _filename + ".tmp");
+        }
+
+        _offset += entry.bytes + padding;
+        _entries.push_back(std::move(entry));
+    }
+
+    void weight_writer::close() {
+        std::string index;
+        for (const weight_entry &entry: _entries) {
+            appendLittleEndian<uint16_t>(index, static_cast<uint16_t>(entry.name.size()));
+            index += entry.name;
+            appendLittleEndian<uint8_t>(index, static_cast<uint8_t>(entry.descr.size()));
+            index += entry.descr;
+            appendLittleEndian<uint8_t>(index, static_cast<uint8_t>(entry.shape.rank()));
+            for (size_t dim: entry.shape) {
+                appendLittleEndian<uint64_t>(index, dim);
+            }
+            appendLittleEndian<uint64_t>(index, entry.offset);
+            appendLittleEndian<uint64_t>(index, entry.bytes);
+            appendLittleEndian<uint64_t>(index, entry.checksum);
+        }
+
+        std::string header(MAGIC);
+        appendLittleEndian<uint32_t>(header, VERSION);
+        appendLittleEndian<uint32_t>(header, static_cast<uint32_t>(_entries.size()));
+        appendLittleEndian<uint64_t>(header, _offset);
+        appendLittleEndian<uint64_t>(header, index.size());
+        appendLittleEndian<uint64_t>(header, checksum64(index.data(), index.size()));
+        header.resize(HEADER_BYTES, '\0');
+
+        _file.write(index.data(), static_cast<std::streamsize>(index.size()));
+        _file.seekp(0);
+        _file.write(header.data(), static_cast<std::streamsize>(header.size()));
+        _file.close();
+        if (!_file) {
+            throw std::runtime_error("\nError writing file (tns::io::weight_writer::close()): " + _filename + ".tmp");
+        }
+
+        // rename() replaces the previous file atomically, there is always a complete file at _filename
+        if (std::rename((_filename + ".tmp").c_str(), _filename.c_str()) != 0) {
+            throw std::runtime_error("\nError renaming file (tns::io::weight_writer::close()): " + _filename);
+        }
+        _closed = true;
+    }
+
+// Reader
+    weight_file::weight_file(const std::string &filename, bool verify)
+            : _file(std::make_shared<mapped_file>(filename, false, true)) {
+        const char *data = _file->data();
+        const size_t size = _file->size();
+        if (size < HEADER_BYTES || std::string_view(data, MAGIC.size()) != MAGIC) {
+            invalidFile(filename + " is not a weight file");
+        }
+
+        index_reader header(data + MAGIC.size(), HEADER_BYTES - MAGIC.size());
+        const auto version = header.number<uint32_t>();
+        const auto count = header.number<uint32_t>();
+        const auto indexOffset = header.number<uint64_t>();
+        const auto indexBytes = header.number<uint64_t>();
+        const auto indexChecksum = header.number<uint64_t>();
+
+        if (version > VERSION) {
+            invalidFile(filename + " has version " + std::to_string(version) + ", this build reads up to "
+                        + std::to_string(VERSION));
+        }
+        if (indexOffset > size || indexBytes > size - indexOffset) {
+            invalidFile(filename + " is truncated");
+        }
+        if (checksum64(data + indexOffset, indexBytes) != indexChecksum) {
+            invalidFile(filename + ": index checksum mismatch");
+        }
+
+        index_reader index(data + indexOffset, indexBytes);
+        for (uint32_t k = 0; k < count; ++k) {
+            weight_entry entry;
+            entry.name = index.text(index.number<uint16_t>());
+            entry.descr = index.text(index.number<uint8_t>());
+            if (version >= 2) {
+                const auto rank = index.number<uint8_t>();
+                if (rank > tensor_shape::max_rank) {
+                    invalidFile(filename + ": tensor \"" + entry.name + "\" has rank " + std::to_string(rank));
+                }
+                size_t dims[tensor_shape::max_rank];
+                for (size_t axis = 0; axis < rank; ++axis) {
+                    dims[axis] = index.number<uint64_t>();
+                }
+                entry.shape = tensor_shape(dims, rank);
+            } else {
+                const auto rows = index.number<uint64_t>();
+                entry.shape = tensor_shape::matrix(rows, index.number<uint64_t>());
+            }
+            entry.offset = index.number<uint64_t>();
+            entry.bytes = index.number<uint64_t>();
+            entry.checksum = index.number<uint64_t>();
+
+            npy_header element;
+            element.descr = entry.descr;
+            if (entry.offset > indexOffset || entry.bytes > indexOffset - entry.offset
+                || entry.bytes != entry.shape.size() * element.itemSize()) {
+                invalidFile(filename + ": tensor \"" + entry.name + "\" lies outside the file");
+            }
+            _entries.push_back(std::move(entry));
+        }
+
+        if (verify) {
+            for (const weight_entry &entry: _entries) {
+                if (!this->verify(entry.name)) {
+                    invalidFile(filename + ": checksum mismatch in tensor \"" + entry.name + "\"");
+                }
+            }
+        }
+    }
+
+    bool weight_file::contains(const std::string &name) const {
+        for (const weight_entry &entry: _entries) {
+            if (entry.name == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template<typename type>
+    tensor<type> weight_file::get(const std::string &name) const {
+        const weight_entry &found = entry(name);
+        char *elements = _file->writableData() + found.offset;
+
+        if (found.descr == npyDescr<type>() && found.shape.size() != 0) {
+            tensor<type> output(reinterpret_cast<type *>(elements), found.shape.rows(), found.shape.cols(), _file);
+            output.reshape(found.shape);
+            return output;
+        }
+
+        tensor<type> output(found.shape);
+        convertNpy(found.descr, elements, output.data().data(), output.size());
+        return output;
+    }
+
+    bool weight_file::verify(const std::string &name) const {
+        const weight_entry &found = entry(name);
+        return checksum64(_file->data() + found.offset, found.bytes) == found.checksum;
+    }
+
+    const weight_entry &weight_file::entry(const std::string &name) const {
+        for (const weight_entry &entry: _entries) {
+            if (entry.name == name) {
+                return entry;
+            }
+        }
+        throw std::out_of_range("\nNo tensor named \"" + name + "\" (tns::io::weight_file)");
+    }
+
+    template void weight_writer::add<int>(const std::string &, const tensor<int> &);
+
+    template void weight_writer::add<double>(const std::string &, const tensor<double> &);
+
+    template void weight_writer::add<float>(const std::string &, const tensor<float> &);
+
+    template tensor<int> weight_file::get<int>(const std::string &) const;
+
+    template tensor<double> weight_file::get<double>(const std::string &) const;
+
+    template tensor<float> weight_file::get<float>(const std::string &) const;
+
+} // tns::io
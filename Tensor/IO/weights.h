@@ -0,0 +1,151 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_WEIGHTS_H
+#define MATRIX_WEIGHTS_H
+
+#include "mapped_file.h"
+#include "../tensor.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tns::io {
+
+    /**
+     * @brief XXH64 hash of a byte range, the checksum of the weight files.
+     */
+    uint64_t checksum64(const void *data, size_t bytes, uint64_t seed = 0);
+
+    /**
+     * @brief One tensor of a weight file.
+     */
+    struct weight_entry {
+        std::string name;
+        std::string descr;     // Element type, as a NumPy descr (see npyDescr())
+        tensor_shape shape;    // All the dimensions of the tensor
+        uint64_t offset = 0;   // Offset of the elements in the file, a multiple of 64
+        uint64_t bytes = 0;
+        uint64_t checksum = 0; // checksum64() of the elements
+    };
+
+    /**
+     * @brief Writes named tensors to a weight file.
+     *
+     * @details
+     * Layout, little-endian:
+     * - a 64-byte header: the magic "TNSWGT\0\0", the format version, the number of tensors, and the offset, size
+     *   and checksum of the index;
+     * - the elements of every tensor, row-major, each starting at a multiple of 64 bytes;
+     * - the index: for every tensor its name, element type, shape (rank, then every dimension), offset, size and
+     *   checksum. Version 1 files, which stored (rows, cols) only, are still read as matrices.
+     *
+     * The file is written as filename + ".tmp" and renamed by close(), so a reader never sees a partial file: a
+     * writer destroyed without close(), e.g. by an exception thrown while adding the tensors, deletes it and leaves
+     * the previous file in place.
+     *
+     * @code
+     * tns::io::weight_writer writer("model.tnsw");
+     * writer.add("w_0", w_0);
+     * writer.add("b_0", b_0);
+     * writer.close();
+     * @endcode
+     */
+    class weight_writer {
+        std::string _filename;
+        std::ofstream _file;
+        std::vector<weight_entry> _entries;
+        uint64_t _offset = 0;
+        bool _closed = false;
+
+    public:
+        /**
+         * @throws std::runtime_error If the file cannot be created.
+         */
+        explicit weight_writer(const std::string &filename);
+
+        weight_writer(const weight_writer &) = delete;
+
+        weight_writer &operator=(const weight_writer &) = delete;
+
+        /**
+         * @brief Delete the temporary file if close() was not called or failed: only close() publishes the file.
+         */
+        ~weight_writer();
+
+        /**
+         * @brief Append a tensor.
+         *
+         * @throws std::invalid_argument If name is empty, longer than 65535 bytes or already used.
+         * @throws std::runtime_error If the file cannot be written.
+         */
+        template<typename type>
+        void add(const std::string &name, const tensor<type> &weights);
+
+        /**
+         * @brief Write the index and the header, then move the file in place.
+         *
+         * @throws std::runtime_error If the file cannot be written or renamed.
+         */
+        void close();
+    };
+
+    /**
+     * @brief A weight file mapped in memory.
+     *
+     * @details
+     * Opening maps the file and reads the index, whose checksum is always checked; the elements are only read when
+     * used. The tensors returned by get() borrow the mapped elements (see tensor::mapped()) and keep the file mapped
+     * after the weight_file is destroyed. The mapping is copy-on-write, so modifying them never changes the file.
+     */
+    class weight_file {
+        std::shared_ptr<mapped_file> _file;
+        std::vector<weight_entry> _entries;
+
+    public:
+        /**
+         * @brief Map filename and read its index.
+         *
+         * @param filename The name of the weight file.
+         * @param verify Also check the checksum of every tensor, which reads the whole file.
+         * @throws std::runtime_error If the file cannot be opened.
+         * @throws std::invalid_argument If it is not a weight file, has a newer version, or a checksum does not
+         * match.
+         */
+        explicit weight_file(const std::string &filename, bool verify = false);
+
+        /**
+         * @brief The tensors of the file, in the order they were added.
+         */
+        [[nodiscard]] const std::vector<weight_entry> &entries() const { return _entries; }
+
+        [[nodiscard]] bool contains(const std::string &name) const;
+
+        /**
+         * @brief Get a tensor by name.
+         *
+         * @return A tensor borrowing the mapped elements if they are of type, a converted copy otherwise.
+         * @throws std::out_of_range If there is no tensor with this name.
+         */
+        template<typename type>
+        tensor<type> get(const std::string &name) const;
+
+        /**
+         * @brief Check the checksum of one tensor, false if it does not match.
+         *
+         * @throws std::out_of_range If there is no tensor with this name.
+         */
+        [[nodiscard]] bool verify(const std::string &name) const;
+
+    private:
+        const weight_entry &entry(const std::string &name) const;
+    };
+
+} // tns::io
+
+#endif //MATRIX_WEIGHTS_H
@@ -0,0 +1,224 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_ELEMENTWISE_H
+#define MATRIX_ELEMENTWISE_H
+
+/**
+ * @file elementwise.h
+ * @brief Element-wise engine behind tensor::elementWise() and tensor::apply(), and the strided copies that
+ * materialize views.
+ *
+ * @details
+ * The callable is a template parameter taken by value, never a std::function: the compiler sees its body, inlines
+ * it into the loop and vectorizes the loop when the body allows it (e.g. ReLU, affine maps). Large arrays are
+ * split into chunks on the thread pool, each chunk running the same inlined loop.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "../Parallel/thread_pool.h"
+#include "../View/tensor_shape.h"
+
+namespace tns::kernel {
+
+    namespace detail {
+
+        // restrict on the parameters (not on locals) is what lets the compiler drop the overlap check
+        template<typename type, typename Function>
+        void transformChunk(const type *__restrict in, type *__restrict out, size_t count, const Function &func) {
+            for (size_t k = 0; k < count; ++k) {
+                out[k] = static_cast<type>(func(in[k]));
+            }
+        }
+
+        template<typename type, typename Function>
+        void transformChunk(type *__restrict data, size_t count, const Function &func) {
+            for (size_t k = 0; k < count; ++k) {
+                data[k] = static_cast<type>(func(data[k]));
+            }
+        }
+
+    }
+
+    /**
+     * @brief out[k] = func(in[k]) for k in [0, count). in and out must not overlap (use transformInPlace).
+     *
+     * @param in Source elements.
+     * @param out Destination elements.
+     * @param count Number of elements.
+     * @param func Unary callable, its result is converted to type.
+     */
+    template<typename type, typename Function>
+    void transform(const type *in, type *out, size_t count, Function func) {
+        parallel::forEachChunk(count, [&](size_t begin, size_t end) {
+            detail::transformChunk(in + begin, out + begin, end - begin, func);
+        });
+    }
+
+    /**
+     * @brief data[k] = func(data[k]) for k in [0, count).
+     *
+     * @param data Elements, overwritten.
+     * @param count Number of elements.
+     * @param func Unary callable, its result is converted to type.
+     */
+    template<typename type, typename Function>
+    void transformInPlace(type *data, size_t count, Function func) {
+        parallel::forEachChunk(count, [&](size_t begin, size_t end) {
+            detail::transformChunk(data + begin, end - begin, func);
+        });
+    }
+
+    /**
+     * @brief out[i * cols + j] = in[i * rowStride + j * colStride]: copy strided elements (a view) into a row-major
+     * buffer. Rows with contiguous elements are copied whole; other layouts, such as a transpose, are copied by
+     * BLOCK x BLOCK tiles so both the reads and the writes stay within a few cache lines.
+     *
+     * @param in First source element.
+     * @param rows Number of rows.
+     * @param cols Number of columns.
+     * @param rowStride Distance between two source rows.
+     * @param colStride Distance between two source columns.
+     * @param out Destination, rows * cols elements, must not overlap in.
+     */
+    template<typename type>
+    void copyStrided(const type *in, size_t rows, size_t cols, size_t rowStride, size_t colStride, type *out) {
+        const bool parallelCopy = rows * cols >= parallel::threshold() && parallel::threadCount() > 1;
+
+        if (colStride == 1 || cols <= 1) {
+            auto copyRows = [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    std::copy_n(in + i * rowStride, cols, out + i * cols);
+                }
+            };
+            if (parallelCopy) {
+                parallel::parallelFor(0, rows, std::max<size_t>(1, parallel::threshold() / cols), copyRows);
+            } else {
+                copyRows(0, rows);
+            }
+            return;
+        }
+
+        constexpr size_t BLOCK = 32;
+        auto copyBlocks = [&](size_t blockBegin, size_t blockEnd) {
+            for (size_t ib = blockBegin * BLOCK; ib < std::min(blockEnd * BLOCK, rows); ib += BLOCK) {
+                const size_t iEnd = std::min(ib + BLOCK, rows);
+                for (size_t jb = 0; jb < cols; jb += BLOCK) {
+                    const size_t jEnd = std::min(jb + BLOCK, cols);
+                    for (size_t i = ib; i < iEnd; ++i) {
+                        const type *source = in + i * rowStride;
+                        type *target = out + i * cols;
+                        for (size_t j = jb; j < jEnd; ++j) {
+                            target[j] = source[j * colStride];
+                        }
+                    }
+                }
+            }
+        };
+
+        const size_t blocks = (rows + BLOCK - 1) / BLOCK;
+        if (parallelCopy) {
+            parallel::parallelFor(0, blocks, 1, copyBlocks);
+        } else {
+            copyBlocks(0, blocks);
+        }
+    }
+
+    /**
+     * @brief Merge each dimension of a strided layout into the previous one when they are contiguous
+     * (strides[k - 1] == strides[k] * dims[k]), and drop the dimensions of size 1. The layout addresses the same
+     * elements in the same order with fewer dimensions: a contiguous (batch x 28 x 28) layout becomes one dimension of
+     * batch * 784 elements, so the copy loops below never see its rank.
+     *
+     * @param rank Number of dimensions.
+     * @param dims Dimensions, overwritten by the collapsed ones.
+     * @param strides Strides, overwritten by the collapsed ones.
+     * @return The number of dimensions left.
+     */
+    inline size_t collapseDims(size_t rank, size_t *dims, size_t *strides) {
+        size_t collapsed = 0;
+        for (size_t k = 0; k < rank; ++k) {
+            if (dims[k] == 1) {
+                continue;
+            }
+            if (collapsed > 0 && strides[collapsed - 1] == strides[k] * dims[k]) {
+                dims[collapsed - 1] *= dims[k];
+                strides[collapsed - 1] = strides[k];
+            } else {
+                dims[collapsed] = dims[k];
+                strides[collapsed] = strides[k];
+                ++collapsed;
+            }
+        }
+        return collapsed;
+    }
+
+    /**
+     * @brief Copy the elements of an N-dimensional strided layout (a view) into a row-major buffer.
+     *
+     * @details
+     * The dimensions are collapsed first (see collapseDims()). A layout left with one contiguous dimension is a
+     * single chunked copy; with at most two dimensions it is the 2-D copy above; otherwise the last two dimensions
+     * are a 2-D copy repeated, in parallel, over every index of the outer ones.
+     *
+     * @param in First source element.
+     * @param shape Dimensions of the layout.
+     * @param strides Distance between two consecutive indices of each dimension.
+     * @param out Destination, shape.size() elements, must not overlap in.
+     */
+    template<typename type>
+    void copyStrided(const type *in, const tensor_shape &shape, const size_t *strides, type *out) {
+        if (shape.size() == 0) {
+            return;
+        }
+
+        size_t dims[tensor_shape::max_rank], steps[tensor_shape::max_rank];
+        std::copy(shape.begin(), shape.end(), dims);
+        std::copy_n(strides, shape.rank(), steps);
+        const size_t rank = collapseDims(shape.rank(), dims, steps);
+
+        if (rank == 0 || (rank == 1 && steps[0] == 1)) {
+            parallel::forEachChunk(rank == 0 ? 1 : dims[0], [&](size_t begin, size_t end) {
+                std::copy(in + begin, in + end, out + begin);
+            });
+            return;
+        }
+        if (rank == 1) {
+            copyStrided(in, dims[0], size_t(1), steps[0], size_t(1), out);
+            return;
+        }
+        if (rank == 2) {
+            copyStrided(in, dims[0], dims[1], steps[0], steps[1], out);
+            return;
+        }
+
+        const size_t rows = dims[rank - 2], cols = dims[rank - 1];
+        size_t outer = 1;
+        for (size_t k = 0; k + 2 < rank; ++k) {
+            outer *= dims[k];
+        }
+
+        auto copyOuter = [&](size_t begin, size_t end) {
+            for (size_t o = begin; o < end; ++o) {
+                size_t offset = 0;
+                for (size_t k = rank - 2, index = o; k-- > 0;) {
+                    offset += (index % dims[k]) * steps[k];
+                    index /= dims[k];
+                }
+                copyStrided(in + offset, rows, cols, steps[rank - 2], steps[rank - 1], out + o * rows * cols);
+            }
+        };
+        if (outer * rows * cols >= parallel::threshold() && parallel::threadCount() > 1) {
+            parallel::parallelFor(0, outer, std::max<size_t>(1, parallel::threshold() / (rows * cols)), copyOuter);
+        } else {
+            copyOuter(0, outer);
+        }
+    }
+
+} // tns::kernel
+
+#endif //MATRIX_ELEMENTWISE_H
@@ -0,0 +1,230 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+/**
+ * @file gemm.cpp
+ * @brief Packed, cache-blocked matrix multiplication used by tensor::operator*.
+ *
+ * @details
+ * The loop nest follows the classic Goto/BLIS structure:
+ * - jc: NC-wide panels of B and C (L3),
+ * - pc: KC-deep slices of A and B, the B panel is packed once per slice,
+ * - ic: MC-tall blocks of A, packed into MR-row slivers (L2),
+ * - jr, ir: MR x NR register tiles computed by the micro-kernel (L1).
+ *
+ * The micro-kernel is picked at run time for the active instruction set (see simd.h). Large products are split
+ * across the thread pool by rows (or columns) of C.
+ */
+
+#include "gemm.h"
+#include "simd.h"
+#include "../Parallel/thread_pool.h"
+#include "../Storage/tensor_storage.h"
+
+#include <algorithm>
+
+namespace tns::kernel {
+
+    namespace {
+
+        // Per-thread packing buffers, grown on demand and reused by every later call
+        template<typename type>
+        struct pack_buffer {
+            type *data = nullptr;
+            size_t capacity = 0;
+
+            type *reserve(size_t count) {
+                if (count > capacity) {
+                    storage::deallocate(data, capacity);
+                    data = storage::allocate<type>(count);
+                    capacity = count;
+                }
+                return data;
+            }
+
+            ~pack_buffer() {
+                storage::deallocate(data, capacity);
+            }
+        };
+
+        // Pack an mc x kc block of A into MR-row slivers: sliver s holds A(s*MR + i, k) at [k * MR + i].
+        // Rows past mc are zero-padded so the micro-kernel never branches on the edge.
+        template<typename type>
+        void packA(size_t mc, size_t kc, const type *A, size_t rsA, size_t csA, type *packed) {
+            constexpr size_t MR = gemm_tile<type>::MR;
+
+            for (size_t ir = 0; ir < mc; ir += MR) {
+                const size_t mr = std::min(MR, mc - ir);
+                for (size_t k = 0; k < kc; ++k) {
+                    for (size_t i = 0; i < mr; ++i) {
+                        packed[i] = A[(ir + i) * rsA + k * csA];
+                    }
+                    for (size_t i = mr; i < MR; ++i) {
+                        packed[i] = 0;
+                    }
+                    packed += MR;
+                }
+            }
+        }
+
+        // Pack a kc x nc panel of B into NR-column slivers: sliver s holds B(k, s*NR + j) at [k * NR + j].
+        template<typename type>
+        void packB(size_t kc, size_t nc, const type *B, size_t rsB, size_t csB, type *packed) {
+            constexpr size_t NR = gemm_tile<type>::NR;
+
+            for (size_t jr = 0; jr < nc; jr += NR) {
+                const size_t nr = std::min(NR, nc - jr);
+                for (size_t k = 0; k < kc; ++k) {
+                    const type *row = B + k * rsB + jr * csB;
+                    for (size_t j = 0; j < nr; ++j) {
+                        packed[j] = row[j * csB];
+                    }
+                    for (size_t j = nr; j < NR; ++j) {
+                        packed[j] = 0;
+                    }
+                    packed += NR;
+                }
+            }
+        }
+
+    }
+
+    template<typename type>
+    gemm_blocking &gemmBlocking() {
+        // KC * (MR + NR) * sizeof(type) fits a 32 KiB L1, MC * KC a 256 KiB - 1 MiB L2
+        static gemm_blocking blocking = (sizeof(type) == 8) ? gemm_blocking{96, 256, 4096}
+                                                            : gemm_blocking{128, 384, 4096};
+        return blocking;
+    }
+
+    namespace {
+
+        template<typename type>
+        void gemmSerial(size_t M, size_t N, size_t K, type alpha,
+                        const type *A, size_t rsA, size_t csA,
+                        const type *B, size_t rsB, size_t csB,
+                        type beta, type *C, size_t rsC, size_t csC) {
+            constexpr size_t MR = gemm_tile<type>::MR;
+            constexpr size_t NR = gemm_tile<type>::NR;
+
+            const gemm_blocking blocking = gemmBlocking<type>();
+            // Round the block sizes to whole register tiles
+            const size_t MC = std::max(MR, blocking.MC / MR * MR);
+            const size_t NC = std::max(NR, blocking.NC / NR * NR);
+            const size_t KC = std::max<size_t>(1, blocking.KC);
+
+            const auto microKernel = simd::kernels<type>().gemmMicroKernel;
+
+            thread_local pack_buffer<type> bufferA, bufferB;
+            type *packedA = bufferA.reserve(MC * KC);
+            type *packedB = bufferB.reserve(KC * NC);
+
+            for (size_t jc = 0; jc < N; jc += NC) {
+                const size_t nc = std::min(NC, N - jc);
+
+                for (size_t pc = 0; pc < K; pc += KC) {
+                    const size_t kc = std::min(KC, K - pc);
+                    // Only the first slice applies the caller's beta, the others accumulate
+                    const type betaSlice = (pc == 0) ? beta : type(1);
+
+                    packB(kc, nc, B + pc * rsB + jc * csB, rsB, csB, packedB);
+
+                    for (size_t ic = 0; ic < M; ic += MC) {
+                        const size_t mc = std::min(MC, M - ic);
+
+                        packA(mc, kc, A + ic * rsA + pc * csA, rsA, csA, packedA);
+
+                        for (size_t jr = 0; jr < nc; jr += NR) {
+                            const size_t nr = std::min(NR, nc - jr);
+                            for (size_t ir = 0; ir < mc; ir += MR) {
+                                const size_t mr = std::min(MR, mc - ir);
+                                microKernel(kc, packedA + ir * kc, packedB + jr * kc, alpha, betaSlice,
+                                            C + (ic + ir) * rsC + (jc + jr) * csC, rsC, csC, mr, nr);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+    }
+
+    template<typename type>
+    void gemm(size_t M, size_t N, size_t K, type alpha,
+              const type *A, size_t rsA, size_t csA,
+              const type *B, size_t rsB, size_t csB,
+              type beta, type *C, size_t rsC, size_t csC) {
+        constexpr size_t MR = gemm_tile<type>::MR;
+        constexpr size_t NR = gemm_tile<type>::NR;
+
+        if (M == 0 || N == 0) {
+            return;
+        }
+
+        if (K == 0 || alpha == type(0)) {
+            for (size_t i = 0; i < M; ++i) {
+                for (size_t j = 0; j < N; ++j) {
+                    type &c = C[i * rsC + j * csC];
+                    c = (beta == type(0)) ? type(0) : beta * c;
+                }
+            }
+            return;
+        }
+
+        // Small products stay on the calling thread. Large ones are split along the dimension with more
+        // register tiles, each chunk running the serial GEMM on its own rows (or columns) of C.
+        const double work = static_cast<double>(M) * N * K;
+        if (work < static_cast<double>(parallel::threshold()) * 64 || parallel::threadCount() <= 1) {
+            gemmSerial(M, N, K, alpha, A, rsA, csA, B, rsB, csB, beta, C, rsC, csC);
+            return;
+        }
+
+        const size_t rowTiles = (M + MR - 1) / MR;
+        const size_t colTiles = (N + NR - 1) / NR;
+
+        if (rowTiles >= colTiles) {
+            parallel::parallelFor(0, rowTiles, 1, [&](size_t begin, size_t end) {
+                const size_t first = begin * MR, last = std::min(M, end * MR);
+                gemmSerial(last - first, N, K, alpha, A + first * rsA, rsA, csA, B, rsB, csB,
+                           beta, C + first * rsC, rsC, csC);
+            });
+        } else {
+            parallel::parallelFor(0, colTiles, 1, [&](size_t begin, size_t end) {
+                const size_t first = begin * NR, last = std::min(N, end * NR);
+                gemmSerial(M, last - first, K, alpha, A, rsA, csA, B + first * csB, rsB, csB,
+                           beta, C + first * csC, rsC, csC);
+            });
+        }
+    }
+
+    template<typename type>
+    void gemmNaive(size_t M, size_t N, size_t K,
+                   const type *A, size_t rsA, size_t csA,
+                   const type *B, size_t rsB, size_t csB,
+                   type *C, size_t rsC, size_t csC) {
+        for (size_t i = 0; i < M; ++i) {
+            for (size_t j = 0; j < N; ++j) {
+                type dotProduct = 0;
+                for (size_t k = 0; k < K; ++k) {
+                    dotProduct += A[i * rsA + k * csA] * B[k * rsB + j * csB];
+                }
+                C[i * rsC + j * csC] = dotProduct;
+            }
+        }
+    }
+
+#define TNS_GEMM_INSTANTIATE(type) \
+    template gemm_blocking &gemmBlocking<type>(); \
+    template void gemm<type>(size_t, size_t, size_t, type, const type *, size_t, size_t, \
+                             const type *, size_t, size_t, type, type *, size_t, size_t); \
+    template void gemmNaive<type>(size_t, size_t, size_t, const type *, size_t, size_t, \
+                                  const type *, size_t, size_t, type *, size_t, size_t);
+
+    TNS_GEMM_INSTANTIATE(int)
+    TNS_GEMM_INSTANTIATE(double)
+    TNS_GEMM_INSTANTIATE(float)
+
+#undef TNS_GEMM_INSTANTIATE
+
+} // tns::kernel
@@ -0,0 +1,81 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_GEMM_H
+#define MATRIX_GEMM_H
+
+#include <cstddef>
+
+namespace tns::kernel {
+
+    /**
+     * @brief Cache blocking parameters of the GEMM.
+     *
+     * @details
+     * - KC: depth of a packed panel. One MR x KC sliver of A plus one KC x NR sliver of B stay in L1.
+     * - MC: rows of the packed block of A (MC x KC), sized to stay in L2.
+     * - NC: columns of the packed panel of B (KC x NC), sized to stay in L3.
+     */
+    struct gemm_blocking {
+        size_t MC, KC, NC;
+    };
+
+    /**
+     * @brief Register tile of the micro-kernel. Each call of the micro-kernel computes an MR x NR block of C
+     * held entirely in registers.
+     */
+    template<typename type>
+    struct gemm_tile;
+
+    template<>
+    struct gemm_tile<double> {
+        static constexpr size_t MR = 4, NR = 8;
+    };
+
+    template<>
+    struct gemm_tile<float> {
+        static constexpr size_t MR = 4, NR = 16;
+    };
+
+    template<>
+    struct gemm_tile<int> {
+        static constexpr size_t MR = 4, NR = 16;
+    };
+
+    /**
+     * @brief Get the blocking parameters used for the given type. The returned reference can be modified to
+     * tune the kernel for a specific cache hierarchy.
+     */
+    template<typename type>
+    gemm_blocking &gemmBlocking();
+
+    /**
+     * @brief General matrix multiplication C = alpha * A * B + beta * C.
+     *
+     * Packed, cache-blocked implementation with a register-blocked micro-kernel. Every matrix is described by a
+     * pointer to its first element plus a row stride (rs) and a column stride (cs), so transposed operands need no
+     * copy. When beta is 0, C is only written, never read.
+     *
+     * @param M Rows of A and C.
+     * @param N Columns of B and C.
+     * @param K Columns of A, rows of B.
+     */
+    template<typename type>
+    void gemm(size_t M, size_t N, size_t K, type alpha,
+              const type *A, size_t rsA, size_t csA,
+              const type *B, size_t rsB, size_t csB,
+              type beta, type *C, size_t rsC, size_t csC);
+
+    /**
+     * @brief Reference i-j-k triple loop, C = A * B. Kept for testing and benchmarking gemm().
+     */
+    template<typename type>
+    void gemmNaive(size_t M, size_t N, size_t K,
+                   const type *A, size_t rsA, size_t csA,
+                   const type *B, size_t rsB, size_t csB,
+                   type *C, size_t rsC, size_t csC);
+
+} // tns::kernel
+
+#endif //MATRIX_GEMM_H
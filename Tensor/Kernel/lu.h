@@ -0,0 +1,57 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_LU_H
+#define MATRIX_LU_H
+
+#include <cstddef>
+#include <vector>
+
+namespace tns::kernel {
+
+    /**
+     * @brief LU factorization with partial pivoting, P A = L U, of an n x n matrix.
+     */
+    template<typename type>
+    struct lu_factors {
+        size_t n = 0;
+        std::vector<type> LU;       // Row-major n x n: L below the diagonal (unit diagonal implied), U on and above
+        std::vector<size_t> pivots; // Row k was swapped with row pivots[k], in order k = 0, 1, ...
+        bool singular = false;      // An exactly zero pivot was found, LU and pivots are incomplete
+        int sign = 1;               // Sign of det(A), 0 when singular
+        double logAbsDet = 0;       // log|det(A)|, -inf when singular
+    };
+
+    /**
+     * @brief Block size of the right-looking LU: panels of NB columns, trailing update through gemm().
+     */
+    constexpr size_t LU_BLOCK = 64;
+
+    /**
+     * @brief Factorize the n x n matrix A (element (i, j) at A[i * rsA + j * csA]) into out.
+     *
+     * Partial pivoting picks the largest magnitude in each column. Factorization stops at the first exactly zero
+     * pivot and marks out as singular, so no division by zero (and no NaN) is ever produced.
+     */
+    template<typename type>
+    void luFactorize(size_t n, const type *A, size_t rsA, size_t csA, lu_factors<type> &out);
+
+    /**
+     * @brief Solve A x = b in place with the factors of a non-singular A, in O(n^2).
+     *
+     * @param factors Factorization of A, must not be singular.
+     * @param b Right-hand side of n elements, overwritten with x.
+     */
+    template<typename type>
+    void luSolve(const lu_factors<type> &factors, type *b);
+
+    /**
+     * @brief Product of the diagonal of U times the sign of the permutation, 0 when singular.
+     */
+    template<typename type>
+    type luDeterminant(const lu_factors<type> &factors);
+
+} // tns::kernel
+
+#endif //MATRIX_LU_H
@@ -0,0 +1,277 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+/**
+ * @file simd.cpp
+ * @brief CPU feature detection, instruction set selection, and the scalar and SSE2 kernels.
+ *
+ * @details
+ * The AVX2 and AVX-512 kernels live in simd_avx.cpp. No file is compiled with -march flags: each instruction set
+ * is enabled for its own region with `#pragma GCC target`, so the binary runs on any x86-64 host and only calls
+ * the wider kernels after cpuid confirmed them.
+ */
+
+#include "simd_isa.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if TNS_SIMD_X86
+#include <cpuid.h>
+#include <emmintrin.h>
+#endif
+
+namespace tns::simd {
+
+    namespace detail {
+
+        namespace generic {
+#include "simd_loops.inl"
+        }
+
+        template<typename T>
+        const kernel_table<T> &scalarTable() {
+            return generic::makeTable<scalar_traits<T>, false>();
+        }
+
+        template const kernel_table<int> &scalarTable<int>();
+
+        template const kernel_table<float> &scalarTable<float>();
+
+        template const kernel_table<double> &scalarTable<double>();
+
+#if TNS_SIMD_X86
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+        struct sse2_ps {
+            using type = float;
+            using reg = __m128;
+            static constexpr size_t width = 4;
+
+            static reg load(const float *p) { return _mm_loadu_ps(p); }
+
+            static reg loadBytes(const unsigned char *p) {
+                int word;
+                std::memcpy(&word, p, 4);
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i bytes = _mm_unpacklo_epi8(_mm_cvtsi32_si128(word), zero);
+                return _mm_cvtepi32_ps(_mm_unpacklo_epi16(bytes, zero));
+            }
+
+            static void store(float *p, reg r) { _mm_storeu_ps(p, r); }
+
+            static reg set1(float x) { return _mm_set1_ps(x); }
+
+            static reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+
+            static reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+
+            static reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+
+            static reg div(reg a, reg b) { return _mm_div_ps(a, b); }
+
+            static reg min(reg a, reg b) { return _mm_min_ps(a, b); }
+
+            static reg max(reg a, reg b) { return _mm_max_ps(a, b); }
+        };
+
+        struct sse2_pd {
+            using type = double;
+            using reg = __m128d;
+            static constexpr size_t width = 2;
+
+            static reg load(const double *p) { return _mm_loadu_pd(p); }
+
+            static reg loadBytes(const unsigned char *p) {
+                return _mm_cvtepi32_pd(_mm_set_epi32(0, 0, p[1], p[0]));
+            }
+
+            static void store(double *p, reg r) { _mm_storeu_pd(p, r); }
+
+            static reg set1(double x) { return _mm_set1_pd(x); }
+
+            static reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+
+            static reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+
+            static reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+
+            static reg div(reg a, reg b) { return _mm_div_pd(a, b); }
+
+            static reg min(reg a, reg b) { return _mm_min_pd(a, b); }
+
+            static reg max(reg a, reg b) { return _mm_max_pd(a, b); }
+        };
+
+        namespace sse2 {
+#include "simd_loops.inl"
+        }
+
+        template<typename T>
+        const kernel_table<T> &sse2Table() {
+            using V = std::conditional_t<std::is_same_v<T, float>, sse2_ps, sse2_pd>;
+            return sse2::makeTable<V, false>();
+        }
+
+        template const kernel_table<float> &sse2Table<float>();
+
+        template const kernel_table<double> &sse2Table<double>();
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+        static std::uint64_t xgetbv0() {
+            std::uint32_t lo, hi;
+            __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+            return (static_cast<std::uint64_t>(hi) << 32) | lo;
+        }
+
+        static isa detectIsa() {
+            unsigned eax, ebx, ecx, edx;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+                return isa::scalar;
+            }
+
+            const bool sse2 = edx & bit_SSE2;
+            const bool osxsave = ecx & bit_OSXSAVE;
+            const bool avx = ecx & bit_AVX;
+            const bool fma = ecx & bit_FMA;
+
+            // The OS must save the YMM (bits 1-2) and ZMM (bits 5-7) register state on context switches
+            const std::uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+            const bool ymmState = (xcr0 & 0x06) == 0x06;
+            const bool zmmState = (xcr0 & 0xe6) == 0xe6;
+
+            bool avx2 = false, avx512f = false;
+            if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+                avx2 = ebx & bit_AVX2;
+                avx512f = ebx & bit_AVX512F;
+            }
+
+            if (avx512f && avx2 && fma && zmmState) {
+                return isa::avx512;
+            }
+            if (avx2 && avx && fma && ymmState) {
+                return isa::avx2;
+            }
+            return sse2 ? isa::sse2 : isa::scalar;
+        }
+
+#else
+
+        static isa detectIsa() {
+            return isa::scalar;
+        }
+
+#endif
+
+        static isa startupIsa() {
+            const isa best = detected();
+            const char *env = std::getenv("TNS_ISA");
+            if (env == nullptr) {
+                return best;
+            }
+
+            const std::string name(env);
+            for (isa candidate: {isa::scalar, isa::sse2, isa::avx2, isa::avx512}) {
+                if (name == isaName(candidate) && candidate <= best) {
+                    return candidate;
+                }
+            }
+            return best;
+        }
+
+        static std::atomic<isa> &activeIsa() {
+            static std::atomic<isa> current{startupIsa()};
+            return current;
+        }
+
+    } // detail
+
+    isa detected() {
+        static const isa best = detail::detectIsa();
+        return best;
+    }
+
+    isa active() {
+        return detail::activeIsa().load(std::memory_order_relaxed);
+    }
+
+    void setIsa(isa target) {
+        if (target > detected()) {
+            std::string message = "\nUnsupported instruction set (tns::simd::setIsa()): ";
+            message += isaName(target);
+            message += " requested, the CPU supports up to ";
+            message += isaName(detected());
+            throw std::invalid_argument(message);
+        }
+
+        detail::activeIsa().store(target, std::memory_order_relaxed);
+    }
+
+    const char *isaName(isa target) {
+        switch (target) {
+            case isa::avx512:
+                return "avx512";
+            case isa::avx2:
+                return "avx2";
+            case isa::sse2:
+                return "sse2";
+            default:
+                return "scalar";
+        }
+    }
+
+    template<typename type>
+    const kernel_table<type> &kernels() {
+        if constexpr (std::is_integral_v<type>) {
+            return detail::scalarTable<type>();
+        } else {
+#if TNS_SIMD_X86
+            switch (active()) {
+                case isa::avx512:
+                    return detail::avx512Table<type>();
+                case isa::avx2:
+                    return detail::avx2Table<type>();
+                case isa::sse2:
+                    return detail::sse2Table<type>();
+                default:
+                    break;
+            }
+
+            // Same rounding as the SIMD GEMM of the best supported instruction set
+            if (detected() >= isa::avx2) {
+                static const kernel_table<type> fusedScalar = [] {
+                    kernel_table<type> table = detail::scalarTable<type>();
+                    table.gemmMicroKernel = detail::fusedScalarGemm<type>();
+                    return table;
+                }();
+                return fusedScalar;
+            }
+#endif
+            return detail::scalarTable<type>();
+        }
+    }
+
+    template const kernel_table<int> &kernels<int>();
+
+    template const kernel_table<float> &kernels<float>();
+
+    template const kernel_table<double> &kernels<double>();
+
+} // tns::simd
@@ -0,0 +1,92 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_SIMD_H
+#define MATRIX_SIMD_H
+
+#include <cstddef>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define TNS_SIMD_X86 1
+#else
+#define TNS_SIMD_X86 0
+#endif
+
+namespace tns::simd {
+
+    /**
+     * @brief Instruction sets the kernels are compiled for, ordered from the least to the most capable.
+     */
+    enum class isa {
+        scalar,
+        sse2,
+        avx2,   // AVX2 + FMA
+        avx512  // AVX-512F
+    };
+
+    /**
+     * @brief Get the best instruction set supported by the CPU (and enabled by the OS), detected once with cpuid.
+     */
+    isa detected();
+
+    /**
+     * @brief Get the instruction set the kernels currently dispatch to.
+     *
+     * Defaults to detected(). The environment variable TNS_ISA (scalar, sse2, avx2 or avx512) can lower it at
+     * start-up.
+     */
+    isa active();
+
+    /**
+     * @brief Override the instruction set the kernels dispatch to.
+     *
+     * @param target The instruction set to use.
+     * @throws std::invalid_argument If the CPU does not support target.
+     */
+    void setIsa(isa target);
+
+    /**
+     * @brief Get the printable name of an instruction set.
+     */
+    const char *isaName(isa target);
+
+    /**
+     * @brief Table of the kernels compiled for one instruction set.
+     *
+     * @details
+     * - Element-wise kernels compute out[i] = a[i] op b[i] (or a[i] op num) over n contiguous elements. They
+     * give bit-identical results on every instruction set.
+     * - gemmMicroKernel computes one MR x NR tile of the GEMM (see gemm.cpp). It keeps the same k-order on every
+     * instruction set, and the scalar fallback uses fused multiply-add whenever the CPU has it, so it matches the GEMM
+     * of detected() bit for bit. SSE2 has no FMA: forcing it on an FMA-capable CPU changes the GEMM rounding.
+     * - minMax writes the smallest and the largest of n > 0 contiguous elements. Exact on every instruction set,
+     * the result is unspecified when the elements contain NaN.
+     * - scaleBytes computes out[i] = bytes[i] * scale + shift, converting unsigned bytes (e.g. pixels) in the same
+     * pass. Multiply then add, never fused, so it is bit-identical on every instruction set.
+     */
+    template<typename type>
+    struct kernel_table {
+        using binary_kernel = void (*)(const type *a, const type *b, type *out, size_t n);
+        using scalar_kernel = void (*)(const type *a, type num, type *out, size_t n);
+        using gemm_kernel = void (*)(size_t kc, const type *a, const type *b, type alpha, type beta,
+                                     type *C, size_t rsC, size_t csC, size_t mr, size_t nr);
+        using reduce_kernel = void (*)(const type *a, size_t n, type *min, type *max);
+        using bytes_kernel = void (*)(const unsigned char *bytes, type scale, type shift, type *out, size_t n);
+
+        binary_kernel add, sub, mul, div;
+        scalar_kernel addScalar, subScalar, mulScalar, divScalar;
+        gemm_kernel gemmMicroKernel;
+        reduce_kernel minMax;
+        bytes_kernel scaleBytes;
+    };
+
+    /**
+     * @brief Get the kernels of the active instruction set. Integer tensors always use the scalar kernels.
+     */
+    template<typename type>
+    const kernel_table<type> &kernels();
+
+} // tns::simd
+
+#endif //MATRIX_SIMD_H
@@ -0,0 +1,254 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+/**
+ * @file simd_avx.cpp
+ * @brief AVX2+FMA and AVX-512F kernels. Only called after cpuid reported the instruction set (see simd.cpp).
+ */
+
+#include "simd_isa.h"
+
+#include <cstring>
+#include <type_traits>
+
+#if TNS_SIMD_X86
+
+#include <immintrin.h>
+
+namespace tns::simd::detail {
+
+// AVX2 + FMA
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+    struct avx2_ps {
+        using type = float;
+        using reg = __m256;
+        static constexpr size_t width = 8;
+
+        static reg load(const float *p) { return _mm256_loadu_ps(p); }
+
+        static reg loadBytes(const unsigned char *p) {
+            return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))));
+        }
+
+        static void store(float *p, reg r) { _mm256_storeu_ps(p, r); }
+
+        static reg set1(float x) { return _mm256_set1_ps(x); }
+
+        static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+
+        static reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+
+        static reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+
+        static reg div(reg a, reg b) { return _mm256_div_ps(a, b); }
+
+        static reg min(reg a, reg b) { return _mm256_min_ps(a, b); }
+
+        static reg max(reg a, reg b) { return _mm256_max_ps(a, b); }
+
+        static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+
+        static float fmaOne(float a, float b, float c) { return __builtin_fmaf(a, b, c); }
+    };
+
+    struct avx2_pd {
+        using type = double;
+        using reg = __m256d;
+        static constexpr size_t width = 4;
+
+        static reg load(const double *p) { return _mm256_loadu_pd(p); }
+
+        static reg loadBytes(const unsigned char *p) {
+            int word;
+            std::memcpy(&word, p, 4);
+            return _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(word)));
+        }
+
+        static void store(double *p, reg r) { _mm256_storeu_pd(p, r); }
+
+        static reg set1(double x) { return _mm256_set1_pd(x); }
+
+        static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+
+        static reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+
+        static reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+
+        static reg div(reg a, reg b) { return _mm256_div_pd(a, b); }
+
+        static reg min(reg a, reg b) { return _mm256_min_pd(a, b); }
+
+        static reg max(reg a, reg b) { return _mm256_max_pd(a, b); }
+
+        static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+
+        static double fmaOne(double a, double b, double c) { return __builtin_fma(a, b, c); }
+    };
+
+    // Width-1 traits compiled with FMA enabled, for the fused scalar GEMM fallback
+    template<typename T>
+    struct fma_scalar {
+        using type = T;
+        using reg = T;
+        static constexpr size_t width = 1;
+
+        static reg load(const T *p) { return *p; }
+
+        static void store(T *p, reg r) { *p = r; }
+
+        static reg set1(T x) { return x; }
+
+        static reg add(reg a, reg b) { return a + b; }
+
+        static reg sub(reg a, reg b) { return a - b; }
+
+        static reg mul(reg a, reg b) { return a * b; }
+
+        static reg div(reg a, reg b) { return a / b; }
+
+        static reg fmadd(reg a, reg b, reg c) { return fmaOne(a, b, c); }
+
+        static T fmaOne(T a, T b, T c) {
+            if constexpr (std::is_same_v<T, float>) {
+                return __builtin_fmaf(a, b, c);
+            } else {
+                return __builtin_fma(a, b, c);
+            }
+        }
+    };
+
+    namespace avx2 {
+#include "simd_loops.inl"
+    }
+
+    template<typename T>
+    const kernel_table<T> &avx2Table() {
+        using V = std::conditional_t<std::is_same_v<T, float>, avx2_ps, avx2_pd>;
+        return avx2::makeTable<V, true>();
+    }
+
+    template const kernel_table<float> &avx2Table<float>();
+
+    template const kernel_table<double> &avx2Table<double>();
+
+    template<typename T>
+    typename kernel_table<T>::gemm_kernel fusedScalarGemm() {
+        return avx2::gemmMicroKernel<fma_scalar<T>, true>;
+    }
+
+    template kernel_table<float>::gemm_kernel fusedScalarGemm<float>();
+
+    template kernel_table<double>::gemm_kernel fusedScalarGemm<double>();
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+// AVX-512F
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx512f,avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx2,fma")
+// GCC 12 reports the _mm512_undefined_*() pass-through of _mm512_min/max as uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+    struct avx512_ps {
+        using type = float;
+        using reg = __m512;
+        static constexpr size_t width = 16;
+
+        static reg load(const float *p) { return _mm512_loadu_ps(p); }
+
+        static reg loadBytes(const unsigned char *p) {
+            return _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))));
+        }
+
+        static void store(float *p, reg r) { _mm512_storeu_ps(p, r); }
+
+        static reg set1(float x) { return _mm512_set1_ps(x); }
+
+        static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+
+        static reg sub(reg a, reg b) { return _mm512_sub_ps(a, b); }
+
+        static reg mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+
+        static reg div(reg a, reg b) { return _mm512_div_ps(a, b); }
+
+        static reg min(reg a, reg b) { return _mm512_min_ps(a, b); }
+
+        static reg max(reg a, reg b) { return _mm512_max_ps(a, b); }
+
+        static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+
+        static float fmaOne(float a, float b, float c) { return __builtin_fmaf(a, b, c); }
+    };
+
+    struct avx512_pd {
+        using type = double;
+        using reg = __m512d;
+        static constexpr size_t width = 8;
+
+        static reg load(const double *p) { return _mm512_loadu_pd(p); }
+
+        static reg loadBytes(const unsigned char *p) {
+            return _mm512_cvtepi32_pd(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))));
+        }
+
+        static void store(double *p, reg r) { _mm512_storeu_pd(p, r); }
+
+        static reg set1(double x) { return _mm512_set1_pd(x); }
+
+        static reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+
+        static reg sub(reg a, reg b) { return _mm512_sub_pd(a, b); }
+
+        static reg mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+
+        static reg div(reg a, reg b) { return _mm512_div_pd(a, b); }
+
+        static reg min(reg a, reg b) { return _mm512_min_pd(a, b); }
+
+        static reg max(reg a, reg b) { return _mm512_max_pd(a, b); }
+
+        static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }
+
+        static double fmaOne(double a, double b, double c) { return __builtin_fma(a, b, c); }
+    };
+
+    namespace avx512 {
+#include "simd_loops.inl"
+    }
+
+    template<typename T>
+    const kernel_table<T> &avx512Table() {
+        using V = std::conditional_t<std::is_same_v<T, float>, avx512_ps, avx512_pd>;
+        return avx512::makeTable<V, true>();
+    }
+
+    template const kernel_table<float> &avx512Table<float>();
+
+    template const kernel_table<double> &avx512Table<double>();
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+} // tns::simd::detail
+
+#endif
@@ -0,0 +1,70 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_SIMD_ISA_H
+#define MATRIX_SIMD_ISA_H
+
+/**
+ * @file simd_isa.h
+ * @brief Internal declarations shared by the per-instruction-set kernel files. Not part of the public API.
+ */
+
+#include <cstddef>
+
+#include "simd.h"
+#include "gemm.h"
+
+namespace tns::simd::detail {
+
+    // Width-1 "vector" traits, used by the scalar fallback
+    template<typename T>
+    struct scalar_traits {
+        using type = T;
+        using reg = T;
+        static constexpr size_t width = 1;
+
+        static reg load(const T *p) { return *p; }
+
+        static reg loadBytes(const unsigned char *p) { return static_cast<T>(*p); }
+
+        static void store(T *p, reg r) { *p = r; }
+
+        static reg set1(T x) { return x; }
+
+        static reg add(reg a, reg b) { return a + b; }
+
+        static reg sub(reg a, reg b) { return a - b; }
+
+        static reg mul(reg a, reg b) { return a * b; }
+
+        static reg div(reg a, reg b) { return a / b; }
+
+        // Same operand order as the SSE/AVX min and max: b is returned when the comparison is false
+        static reg min(reg a, reg b) { return (a < b) ? a : b; }
+
+        static reg max(reg a, reg b) { return (a > b) ? a : b; }
+    };
+
+    // Scalar kernels without fused multiply-add, compiled for the baseline target
+    template<typename T>
+    const kernel_table<T> &scalarTable();
+
+#if TNS_SIMD_X86
+    // Scalar GEMM micro-kernel with fused multiply-add, used as the fallback on CPUs with FMA
+    template<typename T>
+    typename kernel_table<T>::gemm_kernel fusedScalarGemm();
+
+    template<typename T>
+    const kernel_table<T> &sse2Table();
+
+    template<typename T>
+    const kernel_table<T> &avx2Table();
+
+    template<typename T>
+    const kernel_table<T> &avx512Table();
+#endif
+
+} // tns::simd::detail
+
+#endif //MATRIX_SIMD_ISA_H
@@ -0,0 +1,213 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+/**
+ * @file simd_loops.inl
+ * @brief Kernel loops written once against a vector traits type V.
+ *
+ * @details
+ * This file has no include guard on purpose: it is included once per instruction set, inside a
+ * `#pragma GCC target` region, so every template below is compiled for that instruction set only.
+ * V must provide `type`, `reg`, `width`, `load`, `loadBytes` (width unsigned bytes converted to type), `store`,
+ * `set1`, `add`, `sub`, `mul`, `div`, `min` and `max`, plus
+ * `fmadd` and the scalar `fmaOne` when the fused GEMM micro-kernel is instantiated.
+ */
+
+struct add_op {
+    template<typename V>
+    static typename V::reg vec(typename V::reg a, typename V::reg b) { return V::add(a, b); }
+
+    template<typename T>
+    static T one(T a, T b) { return a + b; }
+};
+
+struct sub_op {
+    template<typename V>
+    static typename V::reg vec(typename V::reg a, typename V::reg b) { return V::sub(a, b); }
+
+    template<typename T>
+    static T one(T a, T b) { return a - b; }
+};
+
+struct mul_op {
+    template<typename V>
+    static typename V::reg vec(typename V::reg a, typename V::reg b) { return V::mul(a, b); }
+
+    template<typename T>
+    static T one(T a, T b) { return a * b; }
+};
+
+struct div_op {
+    template<typename V>
+    static typename V::reg vec(typename V::reg a, typename V::reg b) { return V::div(a, b); }
+
+    template<typename T>
+    static T one(T a, T b) { return a / b; }
+};
+
+// out[i] = a[i] op b[i]
+template<typename V, typename Op>
+void binaryLoop(const typename V::type *a, const typename V::type *b, typename V::type *out, size_t n) {
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        V::store(out + i, Op::template vec<V>(V::load(a + i), V::load(b + i)));
+    }
+    for (; i < n; ++i) {
+        out[i] = Op::one(a[i], b[i]);
+    }
+}
+
+// out[i] = a[i] op num
+template<typename V, typename Op>
+void scalarLoop(const typename V::type *a, typename V::type num, typename V::type *out, size_t n) {
+    const typename V::reg vnum = V::set1(num);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        V::store(out + i, Op::template vec<V>(V::load(a + i), vnum));
+    }
+    for (; i < n; ++i) {
+        out[i] = Op::one(a[i], num);
+    }
+}
+
+// Smallest and largest of a[0, n), n > 0. Two accumulator pairs hide the latency of min and max.
+template<typename V>
+void minMaxLoop(const typename V::type *a, size_t n, typename V::type *min, typename V::type *max) {
+    using T = typename V::type;
+    T lo = a[0], hi = a[0];
+    size_t i = 0;
+
+    if (n >= 2 * V::width) {
+        typename V::reg lo0 = V::load(a), lo1 = V::load(a + V::width);
+        typename V::reg hi0 = lo0, hi1 = lo1;
+        for (i = 2 * V::width; i + 2 * V::width <= n; i += 2 * V::width) {
+            const typename V::reg x0 = V::load(a + i), x1 = V::load(a + i + V::width);
+            lo0 = V::min(lo0, x0);
+            lo1 = V::min(lo1, x1);
+            hi0 = V::max(hi0, x0);
+            hi1 = V::max(hi1, x1);
+        }
+
+        alignas(64) T lanes[2][V::width];
+        V::store(lanes[0], V::min(lo0, lo1));
+        V::store(lanes[1], V::max(hi0, hi1));
+        for (size_t l = 0; l < V::width; ++l) {
+            lo = (lanes[0][l] < lo) ? lanes[0][l] : lo;
+            hi = (lanes[1][l] > hi) ? lanes[1][l] : hi;
+        }
+    }
+
+    for (; i < n; ++i) {
+        lo = (a[i] < lo) ? a[i] : lo;
+        hi = (a[i] > hi) ? a[i] : hi;
+    }
+    *min = lo;
+    *max = hi;
+}
+
+#ifndef TNS_NO_FP_CONTRACT
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC contracts a multiply feeding an add into a fused multiply-add, even between intrinsics
+#define TNS_NO_FP_CONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+#define TNS_NO_FP_CONTRACT
+#endif
+#endif
+
+// out[i] = bytes[i] * scale + shift, never fused. The tail goes through one padded vector so it rounds like the body.
+template<typename V>
+TNS_NO_FP_CONTRACT void scaleBytesLoop(const unsigned char *bytes, typename V::type scale, typename V::type shift,
+                    typename V::type *out, size_t n) {
+    using T = typename V::type;
+    const typename V::reg vscale = V::set1(scale), vshift = V::set1(shift);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        V::store(out + i, V::add(V::mul(V::loadBytes(bytes + i), vscale), vshift));
+    }
+    if (i < n) {
+        unsigned char tailBytes[V::width]{};
+        alignas(64) T tail[V::width];
+        for (size_t l = 0; l < n - i; ++l) {
+            tailBytes[l] = bytes[i + l];
+        }
+        V::store(tail, V::add(V::mul(V::loadBytes(tailBytes), vscale), vshift));
+        for (size_t l = 0; l < n - i; ++l) {
+            out[i + l] = tail[l];
+        }
+    }
+}
+
+// MR x NR register tile of the GEMM over packed slivers a (kc x MR) and b (kc x NR), see gemm.cpp.
+// Fused selects fused multiply-add for both the accumulation and the alpha/beta epilogue.
+template<typename V, bool Fused>
+void gemmMicroKernel(size_t kc, const typename V::type *a, const typename V::type *b,
+                     typename V::type alpha, typename V::type beta,
+                     typename V::type *C, size_t rsC, size_t csC, size_t mr, size_t nr) {
+    using T = typename V::type;
+    constexpr size_t MR = tns::kernel::gemm_tile<T>::MR;
+    constexpr size_t NR = tns::kernel::gemm_tile<T>::NR;
+    constexpr size_t NV = NR / V::width;
+    static_assert(NR % V::width == 0, "NR must be a multiple of the vector width");
+
+    typename V::reg acc[MR][NV];
+    for (size_t i = 0; i < MR; ++i) {
+        for (size_t v = 0; v < NV; ++v) {
+            acc[i][v] = V::set1(T(0));
+        }
+    }
+
+    for (size_t k = 0; k < kc; ++k) {
+        typename V::reg bk[NV];
+        for (size_t v = 0; v < NV; ++v) {
+            bk[v] = V::load(b + v * V::width);
+        }
+        for (size_t i = 0; i < MR; ++i) {
+            const typename V::reg ai = V::set1(a[i]);
+            for (size_t v = 0; v < NV; ++v) {
+                if constexpr (Fused) {
+                    acc[i][v] = V::fmadd(ai, bk[v], acc[i][v]);
+                } else {
+                    acc[i][v] = V::add(acc[i][v], V::mul(ai, bk[v]));
+                }
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+
+    alignas(64) T tile[MR][NR];
+    for (size_t i = 0; i < MR; ++i) {
+        for (size_t v = 0; v < NV; ++v) {
+            V::store(&tile[i][v * V::width], acc[i][v]);
+        }
+    }
+
+    for (size_t i = 0; i < mr; ++i) {
+        T *row = C + i * rsC;
+        for (size_t j = 0; j < nr; ++j) {
+            T &c = row[j * csC];
+            if (beta == T(0)) {
+                c = alpha * tile[i][j];
+            } else if constexpr (Fused) {
+                c = V::fmaOne(beta, c, alpha * tile[i][j]);
+            } else {
+                c = alpha * tile[i][j] + beta * c;
+            }
+        }
+    }
+}
+
+// All kernels of this instruction set, for one element type
+template<typename V, bool Fused>
+const tns::simd::kernel_table<typename V::type> &makeTable() {
+    using T = typename V::type;
+    static const tns::simd::kernel_table<T> table{
+            binaryLoop<V, add_op>, binaryLoop<V, sub_op>, binaryLoop<V, mul_op>, binaryLoop<V, div_op>,
+            scalarLoop<V, add_op>, scalarLoop<V, sub_op>, scalarLoop<V, mul_op>, scalarLoop<V, div_op>,
+            gemmMicroKernel<V, Fused>,
+            minMaxLoop<V>,
+            scaleBytesLoop<V>
+    };
+    return table;
+}
@@ -0,0 +1,320 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+/**
+ * @file thread_pool.cpp
+ * @brief Library-wide work-stealing thread pool behind tns::parallel::parallelFor.
+ *
+ * @details
+ * Every worker owns a deque: it pushes and pops its own chunks at the back, and steals from the front of the
+ * other deques when it runs dry. Threads outside the pool share one extra deque. A thread waiting for its chunks
+ * keeps executing chunks instead of blocking, which is what keeps nested parallel calls from deadlocking or
+ * oversubscribing the machine.
+ */
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace tns::parallel {
+
+    namespace {
+
+        // One parallelFor call
+        struct job {
+            const function_ref<void(size_t, size_t)> *body = nullptr;
+            std::atomic<size_t> pending{0};
+            std::mutex errorMutex;
+            std::exception_ptr error;
+        };
+
+        // One chunk of a job
+        struct task {
+            job *owner;
+            size_t begin, end;
+        };
+
+        struct chunk_bounds {
+            size_t begin, end;
+        };
+
+        // Chunk c of count items from begin split into chunks nearly equal chunks, the first ones one item longer
+        chunk_bounds chunkBounds(size_t begin, size_t count, size_t chunks, size_t c) {
+            const size_t step = count / chunks, extra = count % chunks;
+            const size_t first = begin + c * step + std::min(c, extra);
+            return {first, first + step + (c < extra)};
+        }
+
+        // Deque of tasks in a ring buffer that only grows, so steady-state parallelFor calls never allocate
+        struct task_queue {
+            std::mutex mutex;
+            std::vector<task> ring;
+            size_t head = 0, count = 0;
+
+            [[nodiscard]] bool empty() const { return count == 0; }
+
+            void pushBack(const task &chunk) {
+                if (count == ring.size()) {
+                    std::vector<task> larger(std::max<size_t>(64, ring.size() * 2));
+                    for (size_t k = 0; k < count; ++k) {
+                        larger[k] = ring[(head + k) % ring.size()];
+                    }
+                    ring.swap(larger);
+                    head = 0;
+                }
+                ring[(head + count) % ring.size()] = chunk;
+                ++count;
+            }
+
+            task popBack() {
+                --count;
+                return ring[(head + count) % ring.size()];
+            }
+
+            task popFront() {
+                const task chunk = ring[head];
+                head = (head + 1) % ring.size();
+                --count;
+                return chunk;
+            }
+        };
+
+        class pool;
+
+        thread_local pool *currentPool = nullptr;
+        thread_local size_t currentQueue = 0;
+
+        class pool {
+            size_t _workers;
+            std::vector<std::unique_ptr<task_queue>> _queues; // One per worker, plus the shared one at the end
+            std::vector<std::thread> _threads;
+            std::atomic<bool> _stopping{false};
+            std::atomic<size_t> _queued{0};
+            std::mutex _sleepMutex;
+            std::condition_variable _wake;
+
+        public:
+            pool(size_t workers, bool pinThreads) : _workers(workers) {
+                for (size_t i = 0; i <= workers; ++i) {
+                    _queues.emplace_back(std::make_unique<task_queue>());
+                }
+
+                for (size_t i = 0; i < workers; ++i) {
+                    _threads.emplace_back([this, i] { workerLoop(i); });
+#if defined(__linux__)
+                    if (pinThreads) {
+                        cpu_set_t cpus;
+                        CPU_ZERO(&cpus);
+                        CPU_SET(i % std::max(1u, std::thread::hardware_concurrency()), &cpus);
+                        pthread_setaffinity_np(_threads.back().native_handle(), sizeof(cpu_set_t), &cpus);
+                    }
+#else
+                    (void) pinThreads;
+#endif
+                }
+            }
+
+            ~pool() {
+                {
+                    std::lock_guard<std::mutex> lock(_sleepMutex);
+                    _stopping = true;
+                }
+                _wake.notify_all();
+                for (std::thread &thread: _threads) {
+                    thread.join();
+                }
+            }
+
+            [[nodiscard]] size_t workers() const {
+                return _workers;
+            }
+
+            // Index of the deque the calling thread pushes to
+            size_t ownQueue() {
+                return (currentPool == this) ? currentQueue : _workers;
+            }
+
+            // Publish the chunks [1, chunks) of the count items from begin, generated in place (no staging vector)
+            void push(size_t queue, job &owner, size_t begin, size_t count, size_t chunks) {
+                {
+                    std::lock_guard<std::mutex> lock(_queues[queue]->mutex);
+                    for (size_t c = 1; c < chunks; ++c) {
+                        const chunk_bounds bounds = chunkBounds(begin, count, chunks, c);
+                        _queues[queue]->pushBack({&owner, bounds.begin, bounds.end});
+                    }
+                }
+                _queued.fetch_add(chunks - 1);
+                {
+                    std::lock_guard<std::mutex> lock(_sleepMutex);
+                }
+                _wake.notify_all();
+            }
+
+            // Own chunks are taken LIFO (still hot in cache), stolen ones FIFO (the biggest remaining work)
+            bool take(size_t queue, task &out) {
+                {
+                    task_queue &own = *_queues[queue];
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    if (!own.empty()) {
+                        out = own.popBack();
+                        _queued.fetch_sub(1);
+                        return true;
+                    }
+                }
+
+                for (size_t k = 1; k < _queues.size(); ++k) {
+                    task_queue &victim = *_queues[(queue + k) % _queues.size()];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (!victim.empty()) {
+                        out = victim.popFront();
+                        _queued.fetch_sub(1);
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            static void run(const task &chunk) {
+                job &owner = *chunk.owner;
+                try {
+                    (*owner.body)(chunk.begin, chunk.end);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(owner.errorMutex);
+                    if (!owner.error) {
+                        owner.error = std::current_exception();
+                    }
+                }
+                owner.pending.fetch_sub(1, std::memory_order_acq_rel);
+            }
+
+            // Execute chunks until every chunk of owner is done
+            void help(job &owner) {
+                const size_t queue = ownQueue();
+                task chunk{};
+                while (owner.pending.load(std::memory_order_acquire) != 0) {
+                    if (take(queue, chunk)) {
+                        run(chunk);
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+
+        private:
+            void workerLoop(size_t index) {
+                currentPool = this;
+                currentQueue = index;
+
+                task chunk{};
+                while (true) {
+                    if (take(index, chunk)) {
+                        run(chunk);
+                        continue;
+                    }
+
+                    std::unique_lock<std::mutex> lock(_sleepMutex);
+                    _wake.wait(lock, [this] { return _stopping || _queued.load() != 0; });
+                    if (_stopping) {
+                        return;
+                    }
+                }
+            }
+        };
+
+        std::mutex poolMutex;
+        std::unique_ptr<pool> globalPool;
+        std::atomic<size_t> serialThreshold{1 << 15};
+
+        size_t defaultThreads() {
+            if (const char *env = std::getenv("TNS_NUM_THREADS")) {
+                const long threads = std::strtol(env, nullptr, 10);
+                if (threads > 0) {
+                    return static_cast<size_t>(threads);
+                }
+            }
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        pool &instance() {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            if (!globalPool) {
+                globalPool = std::make_unique<pool>(defaultThreads() - 1, false);
+            }
+            return *globalPool;
+        }
+
+    }
+
+    void configure(size_t threads, bool pinThreads) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        std::lock_guard<std::mutex> lock(poolMutex);
+        globalPool.reset();
+        globalPool = std::make_unique<pool>(threads - 1, pinThreads);
+    }
+
+    size_t threadCount() {
+        return instance().workers() + 1;
+    }
+
+    size_t threshold() {
+        return serialThreshold.load(std::memory_order_relaxed);
+    }
+
+    void setThreshold(size_t elements) {
+        serialThreshold.store(std::max<size_t>(1, elements), std::memory_order_relaxed);
+    }
+
+    bool inWorker() {
+        return currentPool != nullptr;
+    }
+
+    void parallelFor(size_t begin, size_t end, size_t grain, function_ref<void(size_t, size_t)> body) {
+        if (begin >= end) {
+            return;
+        }
+
+        pool &threads = instance();
+        const size_t count = end - begin;
+        grain = std::max<size_t>(1, grain);
+
+        // A few chunks per thread so stealing can even out uneven chunks
+        const size_t chunks = std::min((count + grain - 1) / grain, (threads.workers() + 1) * 4);
+        if (chunks <= 1 || threads.workers() == 0) {
+            body(begin, end);
+            return;
+        }
+
+        job owner;
+        owner.body = &body;
+        owner.pending.store(chunks, std::memory_order_relaxed);
+
+        // Publish all chunks but the first one, run the first one here, then help with the rest
+        threads.push(threads.ownQueue(), owner, begin, count, chunks);
+        const chunk_bounds first = chunkBounds(begin, count, chunks, 0);
+        pool::run({&owner, first.begin, first.end});
+        threads.help(owner);
+
+        if (owner.error) {
+            std::rethrow_exception(owner.error);
+        }
+    }
+
+} // tns::parallel
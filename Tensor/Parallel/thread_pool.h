@@ -0,0 +1,113 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_THREAD_POOL_H
+#define MATRIX_THREAD_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace tns::parallel {
+
+    template<typename Signature>
+    class function_ref;
+
+    /**
+     * @brief Non-owning reference to a callable, so passing a capturing lambda to parallelFor never allocates (unlike
+     * std::function).
+     *
+     * The callable must outlive the reference; a temporary lambda passed to parallelFor lives until the call returns.
+     *
+     * @tparam Result: The return type of the callable.
+     * @tparam Args: The argument types of the callable.
+     */
+    template<typename Result, typename... Args>
+    class function_ref<Result(Args...)> {
+        void *_callable;
+        Result (*_invoke)(void *, Args...);
+
+    public:
+        template<typename Callable>
+        requires (!std::is_same_v<std::remove_cvref_t<Callable>, function_ref>)
+                 && std::is_object_v<std::remove_reference_t<Callable>>
+                 && std::is_invocable_r_v<Result, Callable &, Args...>
+        function_ref(Callable &&callable) noexcept
+                : _callable(const_cast<void *>(static_cast<const void *>(std::addressof(callable)))),
+                  _invoke([](void *target, Args... args) -> Result {
+                      return (*static_cast<std::remove_reference_t<Callable> *>(target))(std::forward<Args>(args)...);
+                  }) {}
+
+        Result operator()(Args... args) const {
+            return _invoke(_callable, std::forward<Args>(args)...);
+        }
+    };
+
+    /**
+     * @brief (Re)start the library-wide thread pool.
+     *
+     * The pool is started lazily with one worker per hardware thread on first use. Calling configure() while no
+     * parallel operation is running replaces it. The environment variable TNS_NUM_THREADS sets the default size.
+     *
+     * @param threads Number of threads that execute work, including the calling thread (0 = hardware threads).
+     * 1 makes every operation serial.
+     * @param pinThreads Pin worker i to CPU i (Linux only, ignored elsewhere).
+     */
+    void configure(size_t threads, bool pinThreads = false);
+
+    /**
+     * @brief Get the number of threads that execute work, including the calling thread.
+     */
+    size_t threadCount();
+
+    /**
+     * @brief Get the work size (in elements, or multiply-adds for the GEMM) below which operations stay serial.
+     */
+    size_t threshold();
+
+    /**
+     * @brief Set the work size below which operations stay serial.
+     */
+    void setThreshold(size_t elements);
+
+    /**
+     * @brief Check whether the calling thread is one of the pool workers.
+     */
+    bool inWorker();
+
+    /**
+     * @brief Run body over [begin, end) split into chunks of at least grain indices.
+     *
+     * Chunks are pushed on the deque of the calling worker (or shared between the workers when called from outside
+     * the pool) and idle workers steal them. The caller executes chunks too until all of them are done, so nested
+     * calls from inside a chunk never block a worker and never start extra threads. The first exception thrown by
+     * body is rethrown in the caller once every chunk has finished.
+     *
+     * @param begin First index.
+     * @param end One past the last index.
+     * @param grain Minimum number of indices per chunk.
+     * @param body Called as body(chunkBegin, chunkEnd). Referenced, never copied: a capturing lambda costs no
+     * allocation.
+     */
+    void parallelFor(size_t begin, size_t end, size_t grain, function_ref<void(size_t, size_t)> body);
+
+    /**
+     * @brief Run body over [0, work) in parallel when work reaches threshold(), serially otherwise.
+     *
+     * @param work Number of elements.
+     * @param body Called as body(chunkBegin, chunkEnd).
+     */
+    template<typename Body>
+    void forEachChunk(size_t work, Body &&body) {
+        if (work < threshold() || threadCount() <= 1) {
+            body(size_t(0), work);
+            return;
+        }
+        parallelFor(0, work, threshold() / 4, body);
+    }
+
+} // tns::parallel
+
+#endif //MATRIX_THREAD_POOL_H
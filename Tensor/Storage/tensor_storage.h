@@ -0,0 +1,92 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_TENSOR_STORAGE_H
+#define MATRIX_TENSOR_STORAGE_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace tns::storage {
+
+    /**
+     * @brief Alignment (in bytes) of every tensor buffer. 64 bytes matches a cache line and the widest
+     * SIMD register, so the first element of each tensor never straddles two lines.
+     */
+    constexpr std::size_t ALIGNMENT = 64;
+
+#ifndef TNS_SMALL_TENSOR_SIZE
+#define TNS_SMALL_TENSOR_SIZE 16
+#endif
+
+    /**
+     * @brief Largest number of elements a tensor keeps inline, in the tensor object itself, instead of in an allocated
+     * buffer. Set with TNS_SMALL_TENSOR_SIZE (the TNS_SMALL_TENSOR_SIZE CMake cache variable), the same for every
+     * translation unit since it changes the layout of tns::tensor; 0 always allocates.
+     */
+    constexpr std::size_t SMALL_SIZE = TNS_SMALL_TENSOR_SIZE;
+
+    /**
+     * @brief Process-wide allocation statistics of the tensor buffers, used to check that steady-state loops stop
+     * allocating. Tensors of at most SMALL_SIZE elements allocate nothing and are not counted.
+     */
+    struct allocation_stats {
+        std::size_t allocations; // Number of buffers allocated since start-up
+        std::size_t live;        // Number of buffers currently alive
+        std::size_t liveBytes;   // Bytes held by the live buffers
+    };
+
+    namespace detail {
+        inline std::atomic<std::size_t> allocations{0};
+        inline std::atomic<std::size_t> live{0};
+        inline std::atomic<std::size_t> liveBytes{0};
+    }
+
+    /**
+     * @brief Get a snapshot of the allocation statistics.
+     */
+    inline allocation_stats allocationStats() {
+        return {detail::allocations.load(std::memory_order_relaxed),
+                detail::live.load(std::memory_order_relaxed),
+                detail::liveBytes.load(std::memory_order_relaxed)};
+    }
+
+    /**
+     * @brief Allocate an uninitialized, ALIGNMENT-aligned buffer able to hold `count` elements.
+     *
+     * @tparam type The element type.
+     * @param count The number of elements.
+     * @return Pointer to the first element, or nullptr when count is 0.
+     */
+    template<typename type>
+    type *allocate(std::size_t count) {
+        if (count == 0) {
+            return nullptr;
+        }
+        detail::allocations.fetch_add(1, std::memory_order_relaxed);
+        detail::live.fetch_add(1, std::memory_order_relaxed);
+        detail::liveBytes.fetch_add(count * sizeof(type), std::memory_order_relaxed);
+        return static_cast<type *>(::operator new(count * sizeof(type), std::align_val_t{ALIGNMENT}));
+    }
+
+    /**
+     * @brief Release a buffer obtained from allocate(). Passing nullptr is a no-op.
+     *
+     * @tparam type The element type.
+     * @param buffer The buffer to release.
+     * @param count The number of elements the buffer was allocated with.
+     */
+    template<typename type>
+    void deallocate(type *buffer, std::size_t count) {
+        if (buffer != nullptr) {
+            detail::live.fetch_sub(1, std::memory_order_relaxed);
+            detail::liveBytes.fetch_sub(count * sizeof(type), std::memory_order_relaxed);
+            ::operator delete(buffer, std::align_val_t{ALIGNMENT});
+        }
+    }
+
+} // tns::storage
+
+#endif //MATRIX_TENSOR_STORAGE_H
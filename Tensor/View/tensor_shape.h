@@ -0,0 +1,227 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_TENSOR_SHAPE_H
+#define MATRIX_TENSOR_SHAPE_H
+
+/**
+ * @file tensor_shape.h
+ * @brief Shape of an N-dimensional tensor, and the matrix form every kernel works on.
+ *
+ * @details
+ * A shape is a list of at most max_rank dimensions, stored inline (no allocation). Its matrix form has one row per
+ * index of the leading dimensions and one column per index of the last one: a (batch x 28 x 28) shape is a
+ * (batch * 28 x 28) matrix. A rank-1 shape (n) is a (n x 1) column, like a 1-D .npy file, and the rank-0 shape of a
+ * scalar a (1 x 1) matrix.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace tns {
+
+    class tensor_shape {
+    public:
+        static constexpr size_t max_rank = 8;
+
+        /**
+         * @brief Placeholder for the one dimension of a reshape() deduced from the number of elements.
+         */
+        static constexpr size_t infer = static_cast<size_t>(-1);
+
+    private:
+        std::array<size_t, max_rank> _dims{};
+        size_t _rank{};
+
+    public:
+        /**
+         * @brief Shape of a scalar (rank 0).
+         */
+        constexpr tensor_shape() = default;
+
+        /**
+         * @brief Shape with the given dimensions, e.g. `tensor_shape{64, 3, 32, 32}`.
+         *
+         * @throws std::invalid_argument If there are more than max_rank dimensions.
+         */
+        constexpr tensor_shape(std::initializer_list<size_t> dims) : tensor_shape(dims.begin(), dims.size()) {}
+
+        constexpr tensor_shape(const size_t *dims, size_t rank) : _rank(rank) {
+            if (rank > max_rank) {
+                std::ostringstream message;
+                message << "\nRank too large (tns::tensor_shape): " << rank << " dimensions, at most " << max_rank;
+                throw std::invalid_argument(message.str());
+            }
+            std::copy_n(dims, rank, _dims.begin());
+        }
+
+        /**
+         * @brief Shape of a (rows x cols) matrix.
+         */
+        static constexpr tensor_shape matrix(size_t rows, size_t cols) { return {rows, cols}; }
+
+        [[nodiscard]] constexpr size_t rank() const { return _rank; }
+
+        constexpr size_t operator[](size_t axis) const { return _dims[axis]; }
+
+        constexpr size_t &operator[](size_t axis) { return _dims[axis]; }
+
+        [[nodiscard]] constexpr const size_t *begin() const { return _dims.data(); }
+
+        [[nodiscard]] constexpr const size_t *end() const { return _dims.data() + _rank; }
+
+        /**
+         * @brief Number of elements, the product of the dimensions (1 for a scalar).
+         */
+        [[nodiscard]] constexpr size_t size() const {
+            size_t count = 1;
+            for (size_t axis = 0; axis < _rank; ++axis) {
+                count *= _dims[axis];
+            }
+            return count;
+        }
+
+        /**
+         * @brief Number of rows of the matrix form, the product of all dimensions but the last.
+         */
+        [[nodiscard]] constexpr size_t rows() const {
+            if (_rank <= 1) {
+                return _rank == 0 ? 1 : _dims[0];
+            }
+            size_t count = 1;
+            for (size_t axis = 0; axis + 1 < _rank; ++axis) {
+                count *= _dims[axis];
+            }
+            return count;
+        }
+
+        /**
+         * @brief Number of columns of the matrix form, the last dimension.
+         */
+        [[nodiscard]] constexpr size_t cols() const { return _rank <= 1 ? 1 : _dims[_rank - 1]; }
+
+        /**
+         * @brief Strides of a contiguous row-major buffer of this shape: the last dimension has stride 1.
+         */
+        [[nodiscard]] constexpr std::array<size_t, max_rank> strides() const {
+            std::array<size_t, max_rank> result{};
+            for (size_t axis = _rank, stride = 1; axis-- > 0;) {
+                result[axis] = stride;
+                stride *= _dims[axis];
+            }
+            return result;
+        }
+
+        /**
+         * @brief The shape with its infer dimension, if any, deduced so that it holds count elements.
+         *
+         * @throws std::invalid_argument If several dimensions are infer, or the shape cannot hold count elements.
+         */
+        [[nodiscard]] tensor_shape resolved(size_t count) const {
+            tensor_shape result = *this;
+            size_t known = 1, inferred = max_rank;
+            bool valid = true;
+            for (size_t axis = 0; axis < _rank; ++axis) {
+                if (_dims[axis] != infer) {
+                    known *= _dims[axis];
+                } else if (inferred == max_rank) {
+                    inferred = axis;
+                } else {
+                    valid = false;
+                }
+            }
+
+            if (valid && inferred != max_rank) {
+                valid = known != 0 && count % known == 0;
+                result._dims[inferred] = valid ? count / known : 0;
+            } else if (valid) {
+                valid = known == count;
+            }
+            if (!valid) {
+                std::ostringstream message;
+                message << "\nCannot reshape (tns::tensor_shape): " << count << " elements into " << *this;
+                throw std::invalid_argument(message.str());
+            }
+            return result;
+        }
+
+        /**
+         * @brief The same shape with a dimension of size dim inserted before axis (axis == rank() appends it).
+         */
+        [[nodiscard]] constexpr tensor_shape inserted(size_t axis, size_t dim) const {
+            tensor_shape result;
+            result._rank = _rank + 1;
+            std::copy_n(_dims.begin(), axis, result._dims.begin());
+            result._dims[axis] = dim;
+            std::copy(_dims.begin() + axis, _dims.begin() + _rank, result._dims.begin() + axis + 1);
+            return result;
+        }
+
+        /**
+         * @brief The same shape without the dimension axis.
+         */
+        [[nodiscard]] constexpr tensor_shape erased(size_t axis) const {
+            tensor_shape result;
+            result._rank = _rank - 1;
+            std::copy_n(_dims.begin(), axis, result._dims.begin());
+            std::copy(_dims.begin() + axis + 1, _dims.begin() + _rank, result._dims.begin() + axis);
+            return result;
+        }
+
+        friend constexpr bool operator==(const tensor_shape &lhs, const tensor_shape &rhs) {
+            return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        }
+
+        /**
+         * @brief Print the shape like NumPy, e.g. "(64, 3, 32, 32)".
+         */
+        friend std::ostream &operator<<(std::ostream &COUT, const tensor_shape &shape) {
+            COUT << "(";
+            for (size_t axis = 0; axis < shape._rank; ++axis) {
+                COUT << (axis == 0 ? "" : ", ");
+                if (shape._dims[axis] == infer) {
+                    COUT << "-1";
+                } else {
+                    COUT << shape._dims[axis];
+                }
+            }
+            return COUT << (shape._rank == 1 ? ",)" : ")");
+        }
+    };
+
+    /**
+     * @brief Shape of an element-wise operation between operands of shapes lhs and rhs, with NumPy's broadcasting
+     * rules: the shapes are aligned on their last dimension, the shorter one is padded with 1s, and each pair of
+     * dimensions must be equal or contain a 1, which is repeated. (m x n) with (1 x n) gives (m x n), (m x n) with
+     * (m x 1) gives (m x n), and (m x 1) with (1 x n) gives (m x n).
+     *
+     * @param lhs Shape of the left operand.
+     * @param rhs Shape of the right operand.
+     * @param result Receives the shape of the result.
+     * @return false if the shapes do not broadcast, leaving result unspecified.
+     */
+    inline bool broadcastShape(const tensor_shape &lhs, const tensor_shape &rhs, tensor_shape &result) {
+        const tensor_shape &longer = (lhs.rank() >= rhs.rank()) ? lhs : rhs;
+        const tensor_shape &shorter = (lhs.rank() >= rhs.rank()) ? rhs : lhs;
+        const size_t pad = longer.rank() - shorter.rank();
+
+        result = longer;
+        for (size_t axis = pad; axis < longer.rank(); ++axis) {
+            const size_t a = longer[axis], b = shorter[axis - pad];
+            if (a != b && a != 1 && b != 1) {
+                return false;
+            }
+            result[axis] = (a == 1) ? b : a;
+        }
+        return true;
+    }
+
+} // tns
+
+#endif //MATRIX_TENSOR_SHAPE_H
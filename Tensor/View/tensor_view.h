@@ -0,0 +1,382 @@
+//
+// Created by Hà Tường Nguyên on 10/16/26.
+//
+
+#ifndef MATRIX_TENSOR_VIEW_H
+#define MATRIX_TENSOR_VIEW_H
+
+/**
+ * @file tensor_view.h
+ * @brief Non-owning, read-only strided views of tensor elements.
+ *
+ * @details
+ * A view is a pointer to its first element, a shape and one stride per dimension. Columns, rows, rectangular slices,
+ * transposes and permutations of a tensor (or of another view) are views over the same buffer, built in O(1) without
+ * copying.
+ *
+ * Like a tensor, a view also has a matrix form (see View/tensor_shape.h): element (i, j) is row i of the leading
+ * dimensions and column j of the last one. For views of rank 2 or less, and whenever the leading dimensions collapse
+ * into one (uniform()), element (i, j) is `data()[i * rowStride() + j * colStride()]`. The rows of a permuted view
+ * may not be evenly spaced; at(i, j) then finds the start of row i from the leading dimensions.
+ *
+ * A view is an expression (see Expression/tensor_expression.h): it can be an operand of every element-wise operator
+ * and of elementWise(), and is only copied when it is assigned to a tensor or eval() is called. Matrix
+ * multiplication reads views through their strides, without copying either.
+ *
+ * Like an expression, a view references the tensor it comes from, which must outlive it and must not be resized
+ * while the view is used.
+ */
+
+#include <array>
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../Exception/tensor_error_programing.h"
+#include "../Expression/tensor_expression.h"
+#include "../Kernel/elementwise.h"
+#include "tensor_shape.h"
+
+namespace tns {
+
+    /**
+     * @brief Read-only view of elements laid out with arbitrary strides, in up to tensor_shape::max_rank dimensions.
+     *
+     * @tparam type: The type of the elements.
+     */
+    template<typename type>
+    class tensor_view : public expression<tensor_view<type>> {
+        const type *_data{};
+        tensor_shape _shape;
+        std::array<size_t, tensor_shape::max_rank> _strides{};
+
+        // Matrix form
+        size_t _rows{}, _cols{};
+        size_t _rowStride{}, _colStride{1};
+        bool _uniform{true};
+
+    public:
+        using value_type = type;
+        static constexpr bool is_scalar = false;
+        static constexpr bool is_strided = true;
+
+        /**
+         * @brief View the elements data[i * rowStride + j * colStride], for i < rows and j < cols.
+         */
+        tensor_view(const type *data, size_t rows, size_t cols, size_t rowStride, size_t colStride)
+                : _data(data), _shape{rows, cols}, _strides{rowStride, colStride}, _rows(rows), _cols(cols),
+                  _rowStride(rowStride), _colStride(colStride) {}
+
+        /**
+         * @brief View the elements data[index[0] * strides[0] + ... + index[r - 1] * strides[r - 1]], for every index
+         * within shape.
+         */
+        tensor_view(const type *data, const tensor_shape &shape, const size_t *strides)
+                : _data(data), _shape(shape), _rows(shape.rows()), _cols(shape.cols()) {
+            std::copy_n(strides, shape.rank(), _strides.begin());
+
+            const size_t rank = shape.rank();
+            if (rank == 0) {
+                _rowStride = 1;
+            } else if (rank == 1) {
+                _rowStride = _strides[0];
+            } else {
+                _colStride = _strides[rank - 1];
+
+                // The rows are evenly spaced when the leading dimensions collapse into one
+                size_t dims[tensor_shape::max_rank], steps[tensor_shape::max_rank];
+                std::copy_n(shape.begin(), rank - 1, dims);
+                std::copy_n(_strides.begin(), rank - 1, steps);
+                const size_t leading = kernel::collapseDims(rank - 1, dims, steps);
+                _rowStride = (leading == 0) ? _cols * _colStride : steps[0];
+                _uniform = leading <= 1 || _rows == 0;
+            }
+        }
+
+        [[nodiscard]] size_t row() const { return _rows; }
+
+        [[nodiscard]] size_t col() const { return _cols; }
+
+        [[nodiscard]] size_t size() const { return _rows * _cols; }
+
+        [[nodiscard]] size_t rowStride() const { return _rowStride; }
+
+        [[nodiscard]] size_t colStride() const { return _colStride; }
+
+        [[nodiscard]] const tensor_shape &shape() const { return _shape; }
+
+        [[nodiscard]] size_t ndim() const { return _shape.rank(); }
+
+        /**
+         * @brief Get the stride of every dimension, ndim() values.
+         */
+        [[nodiscard]] const size_t *strides() const { return _strides.data(); }
+
+        /**
+         * @brief Get the first element of the view.
+         */
+        [[nodiscard]] const type *data() const { return _data; }
+
+        /**
+         * @brief Check whether the elements are contiguous in row-major order, as in a tensor.
+         */
+        [[nodiscard]] bool contiguous() const {
+            size_t dims[tensor_shape::max_rank], steps[tensor_shape::max_rank];
+            std::copy(_shape.begin(), _shape.end(), dims);
+            std::copy_n(_strides.begin(), _shape.rank(), steps);
+            const size_t rank = kernel::collapseDims(_shape.rank(), dims, steps);
+            return size() == 0 || rank == 0 || (rank == 1 && steps[0] == 1);
+        }
+
+        /**
+         * @brief Check whether the rows of the matrix form are evenly spaced, rowStride() apart. Always true for views
+         * of rank 2 or less; false for permutations that interleave the leading dimensions.
+         */
+        [[nodiscard]] bool uniform() const { return _uniform; }
+
+        /**
+         * @brief Get the element at the specified row and column of the matrix form.
+         *
+         * @throws OutOfRangeException If (i, j) is outside the view.
+         */
+        type operator()(size_t i, size_t j) const {
+            if (i >= _rows || j >= _cols) {
+                std::ostringstream message;
+                message << "\nMatrix out of range: Position(" << i << ", " << j << ") not belongs to view(" << _rows
+                        << ", " << _cols << ")";
+                throw OutOfRangeException(message.str(), _rows, _cols);
+            }
+            return at(i, j);
+        }
+
+        /**
+         * @brief Get a column of the view, as a (rows x 1) view.
+         *
+         * @throws OutOfRangeException If j >= col().
+         * @throws std::invalid_argument If the rows are not evenly spaced (see uniform()).
+         */
+        [[nodiscard]] tensor_view colView(size_t j) const {
+            return slice(0, _rows, j, j + 1);
+        }
+
+        /**
+         * @brief Get a row of the view, as a (1 x cols) view.
+         *
+         * @throws OutOfRangeException If i >= row().
+         * @throws std::invalid_argument If the rows are not evenly spaced (see uniform()).
+         */
+        [[nodiscard]] tensor_view rowView(size_t i) const {
+            return slice(i, i + 1, 0, _cols);
+        }
+
+        /**
+         * @brief Get the rows [rowBegin, rowEnd) and columns [colBegin, colEnd) of the matrix form, as a 2-D view.
+         *
+         * @throws OutOfRangeException If a range is reversed or goes past the view.
+         * @throws std::invalid_argument If the rows are not evenly spaced (see uniform()).
+         */
+        [[nodiscard]] tensor_view slice(size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd) const {
+            if (rowBegin > rowEnd || rowEnd > _rows || colBegin > colEnd || colEnd > _cols) {
+                std::ostringstream message;
+                message << "\nMatrix out of range: Slice[" << rowBegin << ":" << rowEnd << ", " << colBegin << ":"
+                        << colEnd << "] not belongs to matrix(" << _rows << ", " << _cols << ")";
+                throw OutOfRangeException(message.str(), _rows, _cols);
+            }
+            if (!_uniform) {
+                std::ostringstream message;
+                message << "\nRows not evenly spaced (tns::tensor_view::slice()): view of shape " << _shape
+                        << ", call eval() first";
+                throw std::invalid_argument(message.str());
+            }
+            return {_data + rowBegin * _rowStride + colBegin * _colStride, rowEnd - rowBegin, colEnd - colBegin,
+                    _rowStride, _colStride};
+        }
+
+        /**
+         * @brief Get the transpose of the view, by reversing its dimensions and strides (swapping them in 2-D).
+         */
+        [[nodiscard]] tensor_view T() const {
+            const size_t rank = _shape.rank();
+            tensor_shape shape = _shape;
+            size_t strides[tensor_shape::max_rank];
+            for (size_t k = 0; k < rank; ++k) {
+                shape[k] = _shape[rank - 1 - k];
+                strides[k] = _strides[rank - 1 - k];
+            }
+            return {_data, shape, strides};
+        }
+
+        /**
+         * @brief Reorder the dimensions: dimension k of the result is dimension axes[k] of the view, in O(1).
+         *
+         * @throws std::invalid_argument If axes is not a permutation of [0, ndim()).
+         */
+        [[nodiscard]] tensor_view permute(const std::vector<size_t> &axes) const {
+            const size_t rank = _shape.rank();
+            bool valid = axes.size() == rank;
+            unsigned seen = 0;
+            for (size_t k = 0; valid && k < rank; ++k) {
+                valid = axes[k] < rank && (seen & (1u << axes[k])) == 0;
+                seen |= valid ? (1u << axes[k]) : 0;
+            }
+            if (!valid) {
+                std::ostringstream message;
+                message << "\nInvalid axes (tns::tensor_view::permute()): not a permutation of the " << rank
+                        << " dimensions of " << _shape;
+                throw std::invalid_argument(message.str());
+            }
+
+            tensor_shape shape = _shape;
+            size_t strides[tensor_shape::max_rank];
+            for (size_t k = 0; k < rank; ++k) {
+                shape[k] = _shape[axes[k]];
+                strides[k] = _strides[axes[k]];
+            }
+            return {_data, shape, strides};
+        }
+
+        /**
+         * @brief View the same elements with another shape, in O(1). One dimension may be tensor_shape::infer.
+         *
+         * @throws std::invalid_argument If the shape does not hold size() elements, or the view is not contiguous
+         * (call eval() first).
+         */
+        [[nodiscard]] tensor_view reshape(const tensor_shape &shape) const {
+            const tensor_shape target = shape.resolved(size());
+            if (!contiguous()) {
+                std::ostringstream message;
+                message << "\nNon-contiguous view (tns::tensor_view::reshape()): view of shape " << _shape
+                        << " to " << target << ", call eval() first";
+                throw std::invalid_argument(message.str());
+            }
+            return {_data, target, target.strides().data()};
+        }
+
+        /**
+         * @brief Remove every dimension of size 1, in O(1).
+         */
+        [[nodiscard]] tensor_view squeeze() const {
+            tensor_shape shape;
+            size_t strides[tensor_shape::max_rank];
+            for (size_t axis = 0; axis < _shape.rank(); ++axis) {
+                if (_shape[axis] != 1) {
+                    strides[shape.rank()] = _strides[axis];
+                    shape = shape.inserted(shape.rank(), _shape[axis]);
+                }
+            }
+            return {_data, shape, strides};
+        }
+
+        /**
+         * @brief Remove the dimension axis, of size 1, in O(1).
+         *
+         * @throws std::invalid_argument If axis >= ndim() or its size is not 1.
+         */
+        [[nodiscard]] tensor_view squeeze(size_t axis) const {
+            if (axis >= _shape.rank() || _shape[axis] != 1) {
+                std::ostringstream message;
+                message << "\nInvalid axis (tns::tensor_view::squeeze()): axis " << axis << " of shape " << _shape
+                        << " is not of size 1";
+                throw std::invalid_argument(message.str());
+            }
+            size_t strides[tensor_shape::max_rank];
+            std::copy_n(_strides.begin(), axis, strides);
+            std::copy(_strides.begin() + axis + 1, _strides.begin() + _shape.rank(), strides + axis);
+            return {_data, _shape.erased(axis), strides};
+        }
+
+        /**
+         * @brief Insert a dimension of size 1 before axis (axis == ndim() appends it), in O(1).
+         *
+         * @throws std::invalid_argument If axis > ndim() or the view already has tensor_shape::max_rank dimensions.
+         */
+        [[nodiscard]] tensor_view unsqueeze(size_t axis) const {
+            if (axis > _shape.rank() || _shape.rank() == tensor_shape::max_rank) {
+                std::ostringstream message;
+                message << "\nInvalid axis (tns::tensor_view::unsqueeze()): axis " << axis << " of shape " << _shape;
+                throw std::invalid_argument(message.str());
+            }
+            size_t strides[tensor_shape::max_rank];
+            std::copy_n(_strides.begin(), axis, strides);
+            strides[axis] = 1;
+            std::copy(_strides.begin() + axis, _strides.begin() + _shape.rank(), strides + axis + 1);
+            return {_data, _shape.inserted(axis, 1), strides};
+        }
+
+        // Expression interface, see Expression/tensor_expression.h
+
+        type at(size_t i, size_t j) const { return _data[rowOffset(i) + j * _colStride]; }
+
+        type operator[](size_t k) const { return at(k / _cols, k % _cols); }
+
+        [[nodiscard]] const type *rowData(size_t i) const {
+            return (_colStride == 1 || _cols <= 1) ? _data + rowOffset(i) : nullptr;
+        }
+
+        [[nodiscard]] static constexpr bool broadcasting() { return false; }
+
+        // Whether the view reads elements in [first, last)
+        [[nodiscard]] bool overlaps(const type *first, const type *last) const {
+            if (size() == 0) {
+                return false;
+            }
+            const type *end = _data + 1;
+            for (size_t axis = 0; axis < _shape.rank(); ++axis) {
+                end += (_shape[axis] - 1) * _strides[axis];
+            }
+            return _data < last && first < end;
+        }
+
+    private:
+        // Offset of the first element of row i of the matrix form
+        [[nodiscard]] size_t rowOffset(size_t i) const {
+            if (_uniform) {
+                return i * _rowStride;
+            }
+            size_t offset = 0;
+            for (size_t axis = _shape.rank() - 1; axis-- > 0;) {
+                offset += (i % _shape[axis]) * _strides[axis];
+                i /= _shape[axis];
+            }
+            return offset;
+        }
+    };
+
+    /**
+     * @brief Matrix multiplication of two views, reading both through their strides without copying them.
+     *
+     * @return The result of a NEW tensor.
+     * @throws ShapeMismatchException If lhs.col() != rhs.row().
+     */
+    template<typename type>
+    tensor<type> matmul(const tensor_view<type> &lhs, const tensor_view<type> &rhs);
+
+    namespace expr {
+
+        template<typename Operand>
+        auto asView(const Operand &operand) {
+            if constexpr (is_view_v<Operand>) {
+                return operand;
+            } else {
+                return operand.view();
+            }
+        }
+
+    } // expr
+
+    /**
+     * @brief Matrix multiplication of tensors and views, at least one of them a view (e.g. `X.T() * X`).
+     *
+     * @return The result of a NEW tensor.
+     * @throws ShapeMismatchException If lhs.col() != rhs.row().
+     */
+    template<typename L, typename R> requires expr::strided_matmul_operands<L, R>
+    auto operator*(L &&lhs, R &&rhs) {
+        return matmul(expr::asView(lhs), expr::asView(rhs));
+    }
+
+} // tns
+
+#endif //MATRIX_TENSOR_VIEW_H
@@ -6,64 +6,79 @@
  * @brief This file contains all useful methods for training Neural Networks
  *
  * @methods
- * - display(int precision = 2, bool color = true) -> void
- *   | Print a colorful representation of the tensor.
+ * - display(int precision = 2, bool color = true, size_t threshold = 1000, size_t edgeItems = 3) -> void
+ *   | Print a colorful representation of the tensor, summarized when it is large.
+ *
+ * - heatmap(size_t height = 24, size_t width = 80, io::heatmap_mode mode = mean) -> void
+ *   | Print the tensor downsampled to a colored grid, one cell per block.
  *
  * - det() -> typename
- *   | Calculate the determinant of the tensor.
+ *   | Calculate the determinant of the tensor with a blocked LU factorization.
+ *
+ * - logDet(int *sign = nullptr) -> double
+ *   | Calculate log|det| of the tensor, without overflow.
  *
  * - f() -> tensor<typename>
  *   | COMING SOON! (Provide a brief description if possible.)
  *
- * - multiply(const tensor<typename> &rhs_tensor) -> tensor<typename>
+ * - multiply(rhs_tensor) -> lazy expression (defined in tensor.h)
  *   | Perform the Hadamard product with another tensor.
  *
  * - minor(size_t i, size_t j) -> tensor<typename>
- *   | Calculate the determinant of the subTensor obtained by removing the i-th row and j-th column.
+ *   | Calculate the determinant of the subTensor obtained by removing the i-th row and j-th column, from the
+ *   | cached LU factorization.
  *
  * - subTensor(size_t i, size_t j) -> tensor<typename>
  *   | Create a new tensor by removing the i-th row and j-th column.
  *
- * - read_csv(const std::string &filename, int MAX_ROWS, int MAX_COLS, int precision = 5) -> tensor<double>
- *   | Create a tensor from a CSV file with specified maximum rows and columns.
+ * - read_csv(const std::string &filename, int MAX_ROWS, int MAX_COLS, int precision = 5, io::csv_stats *stats)
+ *   | -> tensor<double>
+ *   | Create a tensor from a CSV file with specified maximum rows and columns, memory-mapped and parsed in parallel.
+ *
+ * - read_csv(const std::string &filename, const io::csv_options &options = {}, io::csv_report *report) -> tensor<double>
+ *   | Create a tensor from a CSV file, discovering its shape in the same pass.
+ *
+ * - write_csv(const std::string &filename, int precision = -1, const std::vector<std::string> &header = {}) -> void
+ *   | Save the tensor as a CSV file, formatted in parallel.
+ *
+ * - read_npy(const std::string &filename, bool map = true) -> tensor<typename>
+ *   | Create a tensor from a NumPy .npy file, borrowing the memory-mapped payload when possible.
+ *
+ * - write_npy(const std::string &filename) -> void
+ *   | Save the tensor as a NumPy .npy file.
  *
- * - T() -> tensor<typename>
- *   | Return the transpose of the tensor.
+ * - T() -> tensor_view<typename>
+ *   | Return the transpose of the tensor as a view, without moving the elements.
+ *
+ * - reshape(shape), squeeze(), squeeze(axis), unsqueeze(axis) -> tensor<typename>& (defined in tensor_init.cpp)
+ *   | Change the shape of the tensor in place, without moving the elements.
+ *
+ * - permute(axes) -> tensor_view<typename> (defined in tensor_operators.cpp)
+ *   | Reorder the dimensions of the tensor as a view, without moving the elements.
  **/
 
 #include "tensor.h"
+#include "Kernel/simd.h"
+#include "Parallel/thread_pool.h"
+#include "IO/csv_cache.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
 
 namespace tns {
 
     // Display tensor
     template<typename type>
-    void tensor<type>::display(int precision, bool color) const {
-        float delta = (_maxValue - _minValue > 0) ? (_maxValue - _minValue) / 7.0 : 1;
-
-        int padding = (std::is_same<type, int>::value) ? 3 : 4; // including space(2), sign-(1), decimal dot(0 or 1)
-        padding -= (_minValue > 0);
-        precision = (std::is_same<type, int>::value) ? 0 : precision;
-
-        type numBeforeDot = std::max(std::abs(_maxValue), std::abs(_minValue));
-        type digits = std::log10(std::max(numBeforeDot, static_cast<type>(1))) + 1; // number before dot
-
-        int width = static_cast<int>(digits + padding + precision);
-
-        std::cout << std::setprecision(precision) << std::fixed;
-
-        for (int i = 0; i < _rows; ++i) {
-            for (int j = 0; j < _cols; ++j) {
-
-                if (color) {
-                    std::cout << color::getColorConstant(round((_tns[i][j] - _minValue) / (delta)));
-                }
-
-                std::cout << std::setw(width) << _tns[i][j] << color::RESET;
-            }
-            std::cout << '\n';
-        }
+    void tensor<type>::display(int precision, bool color, size_t threshold, size_t edgeItems) const {
+        io::printTensor(std::cout, _data, _rows, _cols, _rowStride, _colStride, min(), max(), precision, color,
+                        threshold, edgeItems);
+    }
 
-        std::cout << std::setw(0) << std::setfill(' ') << std::setprecision(6);
+    // Downsampled display
+    template<typename type>
+    void tensor<type>::heatmap(size_t height, size_t width, io::heatmap_mode mode) const {
+        io::printHeatmap(std::cout, _data, _rows, _cols, _rowStride, _colStride, height, width, mode);
     }
 
     // Determinate
@@ -75,17 +90,27 @@ namespace tns {
             throw NotSquareException(message.str(), _rows, _cols);
         }
 
-        if (_rows == 2) {
-            return _tns[0][0] * _tns[1][1] - _tns[1][0] * _tns[0][1];
+        if (_rows == 0) {
+            return 1;
         }
 
-        type result = 0;
-        for (int i = 0; i < _cols; ++i) {
-            tensor<type> tempTensor = subTensor(0, i);
-            result += std::pow((-1), (i)) * _tns[0][i] * tempTensor.det();
+        const lu_type result = kernel::luDeterminant(factorization());
+        if constexpr (std::is_integral_v<type>) {
+            return static_cast<type>(std::llround(result));
+        } else {
+            return result;
         }
+    }
 
-        return result;
+    // Log-determinant
+    template<typename type>
+    double tensor<type>::logDet(int *sign) {
+        const kernel::lu_factors<lu_type> &factors = factorization();
+
+        if (sign != nullptr) {
+            *sign = factors.sign;
+        }
+        return factors.logAbsDet;
     }
 
     // Element-wise function || COMING SOON! Use elementWise() instead!
@@ -94,30 +119,6 @@ namespace tns {
         return tensor<type>(1, 2);
     }
 
-    // Hadamard product
-    template<typename type>
-    tensor<type> tensor<type>::multiply(const tensor<type> &rhs_tensor) const {
-        if (_rows != rhs_tensor._rows || _cols != rhs_tensor._cols) {
-            std::ostringstream message;
-            message << "\nMatrix shape mismatch (^ element-wise production): (" << _rows << ", " << _cols << ") vs ("
-                    << rhs_tensor._rows << ", " << rhs_tensor._cols << ")";
-            throw ShapeMismatchException(message.str(), _rows, _cols, rhs_tensor._rows, rhs_tensor._cols);
-        }
-
-        tensor<type> result(_rows, _cols);
-        type temp;
-
-        for (int i = 0; i < _rows; ++i) {
-            for (int j = 0; j < _cols; ++j) {
-                temp = _tns[i][j] * rhs_tensor._tns[i][j];
-                result.updateMinMaxValues(temp);
-                result._tns[i][j] = temp;
-            }
-        }
-
-        return result;
-    }
-
     // Minor
     template<typename type>
     type tensor<type>::minor(size_t i, size_t j) {
@@ -128,7 +129,25 @@ namespace tns {
             throw OutOfRangeException(message.str(), _rows, _cols);
         }
 
-        return subTensor(i, j).det();
+        const kernel::lu_factors<lu_type> &factors = factorization();
+        if (_rows == 1) {
+            return 1;
+        }
+        if (factors.singular) {
+            return subTensor(i, j).det();
+        }
+
+        // Column i of the inverse, then minor(i, j) = (-1)^(i+j) * det * inverse(j, i)
+        std::vector<lu_type> column(_rows, lu_type(0));
+        column[i] = 1;
+        kernel::luSolve(factors, column.data());
+
+        const lu_type result = (((i + j) % 2 == 0) ? 1 : -1) * kernel::luDeterminant(factors) * column[j];
+        if constexpr (std::is_integral_v<type>) {
+            return static_cast<type>(std::llround(result));
+        } else {
+            return result;
+        }
     }
 
     // Sub-tensor
@@ -149,70 +168,162 @@ namespace tns {
             for (size_t l = 0, resultCol = 0; l < _cols; ++l) {
                 if (l == j) continue;
 
-                result._tns[resultRow][resultCol++] = _tns[k][l];
-                result.updateMinMaxValues(_tns[k][l]);
+                result.at(resultRow, resultCol++) = at(k, l);
             }
 
             ++resultRow;
         }
+        result.invalidateCache();
 
         return result;
     }
 
     // Read data from a CSV file
     template<typename type>
-    tensor<type>
-    tensor<type>::read_csv(const std::string &filename, const int &MAX_ROWS, const int &MAX_COLS, int precision) {
-        std::ifstream file(filename);
-
-        if (!file.is_open()) {
-            std::string message = "\nError opening file (tns::tensor::read_csv()): " + filename;
-            throw std::runtime_error(message);
-        }
+    tensor<type> tensor<type>::read_csv(const std::string &filename, const int &MAX_ROWS, const int &MAX_COLS,
+                                        int precision, io::csv_stats *stats) {
+        const auto start = std::chrono::steady_clock::now();
+        const io::mapped_file file(filename);
+        const double mapSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
         tensor<type> output(MAX_ROWS, MAX_COLS);
+        io::parseCsv(file.view(), output._data, output._rows, output._cols, output._rowStride, precision, stats);
+        output.invalidateCache();
 
-        int numRows = 0, numCols = 0;
-        double decimal = std::pow(10, precision);
-        std::string line, string_cell;
-        type num_cell;
+        if (stats != nullptr) {
+            stats->mapSeconds = mapSeconds;
+        }
 
-        while (std::getline(file, line, '\n') && numRows < MAX_ROWS) {
-            std::istringstream iss(line);
+        return output;
+    }
 
-            while (std::getline(iss, string_cell, ',') && numCols < MAX_COLS) {
-                num_cell = std::round(std::stod(string_cell) * decimal) / decimal;
-                output.pTensor()[numRows][numCols++] = num_cell;
-                output.updateMinMaxValues(num_cell);
+    template<typename type>
+    tensor<type> tensor<type>::read_csv(const std::string &filename, const io::csv_options &options,
+                                        io::csv_report *report) {
+        std::string cacheKey;
+        if (options.cache) {
+            tensor<type> cached;
+            if (io::loadCsvCache(filename, options, cached, report)) {
+                return cached;
             }
+            cacheKey = io::csvCacheKey(filename, options, io::npyDescr<type>());
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const io::mapped_file file(filename);
+        const double mapSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // The skipped lines are cached even when the caller does not ask for them
+        io::csv_report local;
+        io::csv_report *filled = (report != nullptr || !options.cache) ? report : &local;
 
-            numCols = 0;
-            ++numRows;
+        const io::csv_table<type> table = io::loadCsv<type>(file.view(), options, filled);
+        tensor<type> output(table.rows, table.cols);
+        table.copyTo(output._data);
+        output.invalidateCache();
+
+        if (filled != nullptr) {
+            filled->stats.mapSeconds = mapSeconds;
+        }
+        if (options.cache) {
+            io::storeCsvCache(filename, cacheKey, output, *filled);
         }
 
-        file.close();
+        return output;
+    }
+
+    // NumPy files
+    template<typename type>
+    tensor<type> tensor<type>::read_npy(const std::string &filename, bool map) {
+        auto file = std::make_shared<io::mapped_file>(filename, true, true);
+        const io::npy_header header = io::parseNpyHeader(file->view());
+
+        if (header.shape.size() > tensor_shape::max_rank) {
+            std::ostringstream message;
+            message << "\n.npy file with " << header.shape.size() << " dimensions (tns::tensor::read_npy()): "
+                    << filename;
+            throw std::invalid_argument(message.str());
+        }
+        // Scalars and 1-D arrays keep their matrix form, (1 x 1) and (n x 1)
+        const tensor_shape shape = (header.shape.size() > 2)
+                                   ? tensor_shape(header.shape.data(), header.shape.size())
+                                   : tensor_shape::matrix(header.shape.empty() ? 1 : header.shape[0],
+                                                          (header.shape.size() == 2) ? header.shape[1] : 1);
+        const size_t rows = shape.rows(), cols = shape.cols();
+        if (header.itemSize() == 0 || file->size() - header.dataOffset < rows * cols * header.itemSize()) {
+            throw std::invalid_argument("\nTruncated .npy file (tns::tensor::read_npy()): " + filename);
+        }
 
+        char *payload = file->writableData() + header.dataOffset;
+        const bool borrow = map && header.descr == io::npyDescr<type>() && !header.fortranOrder && rows * cols != 0
+                            && reinterpret_cast<uintptr_t>(payload) % alignof(type) == 0;
+        if (borrow) {
+            tensor<type> output(reinterpret_cast<type *>(payload), rows, cols, std::move(file));
+            output.setShape(shape);
+            return output;
+        }
+
+        if (header.fortranOrder && shape.rank() >= 2) {
+            // Column-major elements are the row-major elements of the transpose, whose dimensions are reversed
+            tensor_shape reversed = shape;
+            for (size_t axis = 0; axis < shape.rank(); ++axis) {
+                reversed[axis] = shape[shape.rank() - 1 - axis];
+            }
+            tensor<type> transposed(reversed);
+            io::convertNpy(header.descr, payload, transposed._data, rows * cols);
+            transposed.invalidateCache();
+            return tensor<type>(transposed.T());
+        }
+
+        tensor<type> output(shape);
+        io::convertNpy(header.descr, payload, output._data, rows * cols);
+        output.invalidateCache();
         return output;
     }
 
-    // Transpose
     template<typename type>
-    tensor<type> tensor<type>::T() {
-        #pragma clang diagnostic push
-        #pragma ide diagnostic ignored "ArgumentSelectionDefects"
-        tensor<type> result(_cols, _rows);
-        #pragma clang diagnostic pop
-
-        for (int i = 0; i < _rows; ++i) {
-            for (int j = 0; j < _cols; ++j) {
-                result._tns[j][i] = _tns[i][j];
+    void tensor<type>::write_csv(const std::string &filename, int precision,
+                                 const std::vector<std::string> &header) const {
+        if (!header.empty() && header.size() != _cols) {
+            std::ostringstream message;
+            message << "\nHeader size mismatch (tns::tensor::write_csv()): " << header.size() << " names for "
+                    << _cols << " columns";
+            throw std::invalid_argument(message.str());
+        }
+        io::writeCsv(filename, _data, _rows, _cols, _rowStride, _colStride, precision, header);
+    }
+
+    template<typename type>
+    void tensor<type>::write_npy(const std::string &filename) const {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("\nError opening file (tns::tensor::write_npy()): " + filename);
+        }
+
+        const std::string header = io::formatNpyHeader(io::npyDescr<type>(), {_shape.begin(), _shape.end()});
+        file.write(header.data(), static_cast<std::streamsize>(header.size()));
+        if (_rowStride == _cols && _colStride == 1) {
+            file.write(reinterpret_cast<const char *>(_data), static_cast<std::streamsize>(size() * sizeof(type)));
+        } else {
+            std::vector<type> row(_cols);
+            for (size_t i = 0; i < _rows; ++i) {
+                for (size_t j = 0; j < _cols; ++j) {
+                    row[j] = at(i, j);
+                }
+                file.write(reinterpret_cast<const char *>(row.data()),
+                           static_cast<std::streamsize>(_cols * sizeof(type)));
             }
         }
 
-        result._minValue = min();
-        result._maxValue = max();
+        if (!file) {
+            throw std::runtime_error("\nError writing file (tns::tensor::write_npy()): " + filename);
+        }
+    }
 
-        return result;
+    // Transpose
+    template<typename type>
+    tensor_view<type> tensor<type>::T() const & {
+        return view().T();
     }
 
 }
@@ -13,26 +13,76 @@
 #include <cmath>
 #include <random>
 #include <limits>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <span>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 
 #include "Exception/tensor_error_programing.h"
+#include "Storage/tensor_storage.h"
+#include "Expression/tensor_expression.h"
+#include "View/tensor_view.h"
+#include "Kernel/simd.h"
+#include "Kernel/elementwise.h"
+#include "Kernel/lu.h"
+#include "IO/csv.h"
+#include "IO/format.h"
+#include "IO/mapped_file.h"
+#include "IO/npy.h"
+#include "Parallel/thread_pool.h"
 #include "../Color/color.h"
 
 namespace tns {
 
+    namespace io {
+        class weight_file;
+    }
+
     /**
      * @brief A generic tensor class template representing a mathematical tensor.
      *
      * This class provides functionalities for tensor creation, manipulation, and various operations.
      * It supports element-wise operations, matrix multiplication, and basic linear algebra operations.
      *
+     * Elements live in one contiguous, 64-byte aligned buffer in row-major order. A tensor has up to
+     * tensor_shape::max_rank dimensions (shape()); every kernel works on its matrix form (see View/tensor_shape.h), of
+     * row() = the product of the leading dimensions and col() = the last dimension. Element (i, j) of the matrix form is
+     * stored at `_data[i * _rowStride + j * _colStride]`. Since the buffer is always contiguous, reshape(), squeeze()
+     * and unsqueeze() only change the shape, and the element-wise kernels run on one flat array whatever the rank.
+     * A tensor of at most storage::SMALL_SIZE elements keeps them in the object itself, and never allocates.
+     *
+     * The minimum and maximum are computed on the first call to min() or max(), and the LU factorization on the
+     * first call to det(), logDet() or minor(). Both are cached until the tensor is modified, so the arithmetic
+     * kernels never track them. The minimum and maximum are published under a lock, so several threads may call min()
+     * and max() on a shared tensor at once; modifying it while another thread reads it is a data race, as for any
+     * container.
+     *
      * @tparam type: The type of elements stored in the tensor.
      */
     template<typename type>
     class tensor {
-        size_t _rows{}, _cols{};
-        type _maxValue = -std::numeric_limits<type>::infinity();
-        type _minValue = std::numeric_limits<type>::infinity();
-        type **_tns;
+        // Integer matrices are factorized in double
+        using lu_type = std::conditional_t<std::is_integral_v<type>, double, type>;
+
+        tensor_shape _shape;
+        size_t _rows{}, _cols{}; // Matrix form of _shape
+        size_t _rowStride{}, _colStride{1};
+        mutable type _maxValue = -std::numeric_limits<type>::infinity();
+        mutable type _minValue = std::numeric_limits<type>::infinity();
+        mutable std::atomic<bool> _minMaxDirty{true};
+        mutable std::unique_ptr<kernel::lu_factors<lu_type>> _lu; // Built by det(), logDet() and minor()
+        mutable std::mutex _minMaxMutex; // Serializes the publication of _minValue and _maxValue by const readers
+        type *_data{};
+        std::shared_ptr<const void> _owner; // Keeps borrowed elements (a mapped file) alive, null if _data is owned
+        mutable type **_rowTable{};
+        alignas(storage::ALIGNMENT) std::array<type, storage::SMALL_SIZE> _inline; // _data of a small tensor
+
+        friend class io::weight_file; // Wraps mapped elements
 
 
     public:
@@ -74,6 +124,68 @@ namespace tns {
          */
         tensor(type *array, size_t rows, size_t cols = 1);
 
+        // N-dimensional constructor
+        /**
+         * @brief Constructor to create a tensor of any shape, e.g. `tensor<float>(tensor_shape{64, 3, 32, 32})`.
+         *
+         * @param shape The dimensions of the tensor.
+         * @param initData The initial value to fill the tensor (default is 0).
+         */
+        explicit tensor(const tensor_shape &shape, type initData = 0);
+
+        // Copy and move
+        /**
+         * @brief Copy constructor, performs a deep copy of the elements.
+         *
+         * @param other The tensor to copy.
+         */
+        tensor(const tensor &other);
+
+        /**
+         * @brief Move constructor, takes over the buffer of other. other is left as an empty (0x0) tensor. The
+         * elements of a small tensor are copied out of its inline buffer, views of other do not follow them.
+         *
+         * @param other The tensor to move from.
+         */
+        tensor(tensor &&other) noexcept;
+
+        /**
+         * @brief Copy assignment, performs a deep copy. The existing buffer is reused when the sizes match, unless it
+         * is borrowed (see mapped()): the copy always owns its elements.
+         *
+         * @param other The tensor to copy.
+         * @return Reference to this tensor.
+         */
+        tensor &operator=(const tensor &other);
+
+        /**
+         * @brief Move assignment, releases the current buffer and takes over the buffer of other, like the move
+         * constructor.
+         *
+         * @param other The tensor to move from.
+         * @return Reference to this tensor.
+         */
+        tensor &operator=(tensor &&other) noexcept;
+
+        // From expression
+        /**
+         * @brief Evaluate an expression into a NEW tensor, in one pass and without temporaries.
+         *
+         * @param expression The expression, e.g. `w * x + b` or `X.elementWise(ReLU) * 2.0`.
+         */
+        template<typename Derived>
+        tensor(const expression<Derived> &expression);
+
+        /**
+         * @brief Evaluate an expression into this tensor. The existing buffer is reused when the sizes match and it
+         * is owned; otherwise the expression is evaluated into a new buffer first, since it may read this tensor.
+         *
+         * @param expression The expression to evaluate.
+         * @return Reference to this tensor.
+         */
+        template<typename Derived>
+        tensor &operator=(const expression<Derived> &expression);
+
         //  tensor_init.cpp/Destructor
         virtual ~tensor();
 
@@ -93,26 +205,128 @@ namespace tns {
         [[nodiscard]] [[maybe_unused]] size_t col() const;
 
         /**
-         * @brief Get the maximum value in the tensor.
+         * @brief Get the dimensions of the tensor. row() and col() are its matrix form.
+         *
+         * @return The shape, of rank 2 for tensors created with a number of rows and columns.
+         */
+        [[nodiscard]] [[maybe_unused]] const tensor_shape &shape() const;
+
+        /**
+         * @brief Get the number of dimensions of the tensor.
+         *
+         * @return shape().rank().
+         */
+        [[nodiscard]] [[maybe_unused]] size_t ndim() const;
+
+        /**
+         * @brief Get the maximum value in the tensor, computed on first use after a modification.
          *
          * @return The maximum value.
          */
         [[nodiscard]] [[maybe_unused]] type max() const;
 
         /**
-         * @brief Get the minimum value in the tensor.
+         * @brief Get the minimum value in the tensor, computed on first use after a modification.
          *
          * @return The minimum value.
          */
         [[nodiscard]] [[maybe_unused]] type min() const;
 
         /**
-         * @brief Get the pointer to the tensor data.
+         * @brief Get the number of elements in the tensor.
+         *
+         * @return rows * cols.
+         */
+        [[nodiscard]] [[maybe_unused]] size_t size() const;
+
+        /**
+         * @brief Get the distance (in elements) between two consecutive rows.
+         *
+         * @return The row stride.
+         */
+        [[nodiscard]] [[maybe_unused]] size_t rowStride() const;
+
+        /**
+         * @brief Get the distance (in elements) between two consecutive columns.
+         *
+         * @return The column stride.
+         */
+        [[nodiscard]] [[maybe_unused]] size_t colStride() const;
+
+        /**
+         * @brief Get the contiguous element buffer of the tensor. The cached minimum and maximum are invalidated.
          *
-         * @return The pointer to the tensor data.
+         * @return A span over all elements, in row-major order.
+         */
+        [[nodiscard]] [[maybe_unused]] std::span<type> data();
+
+        /**
+         * @brief Get the contiguous element buffer of the tensor (read-only).
+         *
+         * @return A span over all elements, in row-major order.
+         */
+        [[nodiscard]] [[maybe_unused]] std::span<const type> data() const;
+
+        /**
+         * @brief Get a table of row pointers into the tensor data.
+         *
+         * @deprecated Compatibility shim for code written against the old row-of-arrays layout. The table is built
+         * on the first call and points into the contiguous buffer; use data() in new code.
+         *
+         * @return The row pointer table, `pTensor()[i][j]` is element (i, j).
          */
         [[nodiscard]] [[maybe_unused]] type **pTensor() const;
 
+        /**
+         * @brief Check whether the elements are borrowed from a memory-mapped file (see read_npy()) instead of
+         * owned by the tensor.
+         */
+        [[nodiscard]] [[maybe_unused]] bool mapped() const;
+
+    //  tensor_init.cpp/Shape
+        // The buffer is contiguous, so changing the shape never moves an element
+        /**
+         * @brief Give the tensor another shape with the same number of elements, in O(1) and in place.
+         *
+         * @param shape The new dimensions. One of them may be tensor_shape::infer, deduced from size().
+         * @return Reference to this tensor (a tensor moved from it, when called on a temporary).
+         * @throws std::invalid_argument If shape does not hold size() elements.
+         */
+        tensor &reshape(const tensor_shape &shape) &;
+
+        tensor reshape(const tensor_shape &shape) && { return std::move(reshape(shape)); }
+
+        /**
+         * @brief Remove every dimension of size 1, in O(1) and in place.
+         *
+         * @return Reference to this tensor (a tensor moved from it, when called on a temporary).
+         */
+        tensor &squeeze() &;
+
+        tensor squeeze() && { return std::move(squeeze()); }
+
+        /**
+         * @brief Remove the dimension axis, of size 1, in O(1) and in place.
+         *
+         * @param axis The dimension to remove.
+         * @return Reference to this tensor (a tensor moved from it, when called on a temporary).
+         * @throws std::invalid_argument If axis >= ndim() or its size is not 1.
+         */
+        tensor &squeeze(size_t axis) &;
+
+        tensor squeeze(size_t axis) && { return std::move(squeeze(axis)); }
+
+        /**
+         * @brief Insert a dimension of size 1 before axis (axis == ndim() appends it), in O(1) and in place.
+         *
+         * @param axis Position of the new dimension.
+         * @return Reference to this tensor (a tensor moved from it, when called on a temporary).
+         * @throws std::invalid_argument If axis > ndim() or the tensor already has tensor_shape::max_rank dimensions.
+         */
+        tensor &unsqueeze(size_t axis) &;
+
+        tensor unsqueeze(size_t axis) && { return std::move(unsqueeze(axis)); }
+
     // tensor_operators.cpp/Overload operators
         // Getting element
         /**
@@ -126,88 +340,121 @@ namespace tns {
 
         // Getting column
         /**
-         * @brief Get a column of the tensor.
+         * @brief Get a column of the tensor, as a (rows x 1) view over its elements, in O(1).
+         *
+         * Assign it to a tensor (or call eval()) to copy the column.
          *
          * @param j The column index.
-         * @return A tensor representing the specified column.
+         * @return A view of the specified column.
+         * @throws OutOfRangeException If j >= col().
          */
-        tensor operator[](size_t j) const;
+        tensor_view<type> operator[](size_t j) const &;
 
-        // Matrix multiplication
+        tensor_view<type> operator[](size_t j) const && = delete;
+
+        // Views
+        // A view does not own the elements: taking one of a temporary tensor, e.g. `(A * B).T()`, does not compile,
+        // since it would dangle. Store the temporary in a tensor first.
         /**
-         * @brief Multiply the tensor with another tensor using matrix multiplication. Noted that
-         * this operator is different from multiply method.
+         * @brief Get a view of the whole tensor, in O(1).
+         */
+        [[nodiscard]] tensor_view<type> view() const &;
+
+        tensor_view<type> view() const && = delete;
+
+        /**
+         * @brief Get a column of the tensor, as a (rows x 1) view, in O(1). Same as operator[].
          *
-         * @param rhs_tensor The right-hand side tensor.
-         * @return The result of a NEW tensor.
+         * @throws OutOfRangeException If j >= col().
          */
-        tensor operator*(const tensor<type> &rhs_tensor) const;
+        [[nodiscard]] tensor_view<type> colView(size_t j) const &;
+
+        tensor_view<type> colView(size_t j) const && = delete;
 
-        // Binary operation
         /**
-         * @brief Add another tensor to this tensor.
+         * @brief Get a row of the tensor, as a (1 x cols) view, in O(1).
          *
-         * @param rhs_tensor The right-hand side tensor.
-         * @return The result of a NEW tensor.
+         * @throws OutOfRangeException If i >= row().
          */
-        tensor operator+(const tensor<type> &rhs_tensor) const;
+        [[nodiscard]] tensor_view<type> rowView(size_t i) const &;
+
+        tensor_view<type> rowView(size_t i) const && = delete;
 
         /**
-         * @brief Subtract another tensor from this tensor.
+         * @brief Get the rows [rowBegin, rowEnd) and columns [colBegin, colEnd) of the tensor, as a view, in O(1).
          *
-         * @param rhs_tensor The right-hand side tensor.
-         * @return The result of a NEW tensor.
+         * @throws OutOfRangeException If a range is reversed or goes past the tensor.
          */
-        tensor operator-(const tensor<type> &rhs_tensor) const;
+        [[nodiscard]] tensor_view<type>
+        slice(size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd) const &;
+
+        tensor_view<type> slice(size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd) const && = delete;
 
         /**
-         * @brief Divide this tensor by another tensor element-wise.
+         * @brief Reorder the dimensions, as a view, in O(1): dimension k of the view is dimension axes[k] of the
+         * tensor, e.g. `X.permute({0, 2, 3, 1})` turns NCHW into NHWC. Assign it to a tensor to copy it.
          *
-         * @param rhs_tensor The right-hand side tensor.
-         * @return The result of a NEW tensor.
+         * @throws std::invalid_argument If axes is not a permutation of [0, ndim()).
          */
-        tensor operator/(const tensor<type> &rhs_tensor) const;
+        [[nodiscard]] tensor_view<type> permute(const std::vector<size_t> &axes) const &;
 
-    // Scalar/Element-wise operators
+        tensor_view<type> permute(const std::vector<size_t> &axes) const && = delete;
+
+        // Matrix multiplication
         /**
-         * @brief Add a scalar value to each element of the tensor.
+         * @brief Multiply the tensor with another tensor using matrix multiplication. Noted that
+         * this operator is different from multiply method.
          *
-         * @param num The scalar value to add.
+         * @param rhs_tensor The right-hand side tensor.
          * @return The result of a NEW tensor.
          */
-        tensor operator+(const type &num) const;
+        tensor operator*(const tensor<type> &rhs_tensor) const;
+
+        // Element-wise operators
+        // +, -, /, the scalar operators and ^ are free functions returning lazy expressions, see
+        // Expression/tensor_expression.h
 
+        // Compound assignment
         /**
-         * @brief Subtract a scalar value from each element of the tensor.
+         * @brief Add a tensor, an expression or a scalar to this tensor, in place and without allocating.
          *
-         * @param num The scalar value to subtract.
-         * @return The result of a NEW tensor.
+         * @param rhs The right-hand side operand.
+         * @return Reference to this tensor.
+         * @throws ShapeMismatchException If rhs does not broadcast to the shape of this tensor.
          */
-        tensor operator-(const type &num) const;
+        template<typename Rhs> requires expr::is_operand_v<Rhs>
+        tensor &operator+=(Rhs &&rhs);
 
         /**
-         * @brief Multiply each element of the tensor by a scalar value.
+         * @brief Subtract a tensor, an expression or a scalar from this tensor, in place and without allocating.
          *
-         * @param num The scalar value to multiply.
-         * @return The result of a NEW tensor.
+         * @param rhs The right-hand side operand.
+         * @return Reference to this tensor.
+         * @throws ShapeMismatchException If rhs does not broadcast to the shape of this tensor.
          */
-        tensor operator*(const type &num) const;
+        template<typename Rhs> requires expr::is_operand_v<Rhs>
+        tensor &operator-=(Rhs &&rhs);
 
         /**
-         * @brief Divide each element of the tensor by a scalar value.
+         * @brief Multiply each element by a scalar, in place. Use `X = X.multiply(Y)` for the Hadamard product and
+         * gemm() for an in-place matrix multiplication.
          *
-         * @param num The scalar value to divide by.
-         * @return The result of a NEW tensor.
+         * @param num The scalar factor.
+         * @return Reference to this tensor.
          */
-        tensor operator/(const type &num) const;
+        template<typename Rhs> requires expr::is_scalar_v<Rhs>
+        tensor &operator*=(Rhs num);
 
         /**
-         * @brief Raise each element of the tensor to the power of a scalar value.
+         * @brief Divide this tensor element-wise by a tensor, an expression or a scalar, in place and without
+         * allocating.
          *
-         * @param num The scalar value representing the exponent.
-         * @return The result of a NEW tensor.
+         * @param rhs The right-hand side operand.
+         * @return Reference to this tensor.
+         * @throws ShapeMismatchException If rhs does not broadcast to the shape of this tensor.
          */
-        tensor operator^(const type &num) const;
+        template<typename Rhs> requires expr::is_operand_v<Rhs>
+        tensor &operator/=(Rhs &&rhs);
 
     // tensor.cpp/Public method
         // Print the tensor
@@ -221,20 +468,59 @@ namespace tns {
          * the color parameter, when set to true (default), highlights the tensor values using a color scale.
          * - The color scale divides the range between Max_value and Min_value into 7 segments, ranging from
          * White < Magenta < Cyan < Blue < Green < Yellow < Red.
+         * - The tensor is formatted into one buffer and written with a single call (see io::printTensor()); the
+         * state of std::cout is left unchanged.
+         * - A tensor of more than threshold elements is summarized like NumPy does: only edgeItems rows and columns
+         * at each end are printed, separated by "...". Use heatmap() to see the whole of a large tensor.
          *
          * @param precision The number of decimal places to display (default is 2).
          * @param color Whether to display the tensor with color highlights (default is true).
+         * @param threshold Largest number of elements printed in full (default is 1000).
+         * @param edgeItems Number of rows and columns printed at each end when summarized (default is 3).
          */
-        void display(int precision = 2, bool color = true) const;
+        void display(int precision = 2, bool color = true, size_t threshold = 1000, size_t edgeItems = 3) const;
+
+        /**
+         * @brief Displays the tensor downsampled to a colored grid of at most height x width cells.
+         *
+         * @details
+         * Each cell shows the mean or the largest element of one block of the tensor, on the same 7-level color scale
+         * as display() (see io::printHeatmap()). The blocks are reduced in parallel, so a tensor of millions of
+         * elements is rendered in milliseconds.
+         *
+         * @param height Largest number of lines (default is 24).
+         * @param width Largest number of columns (default is 80).
+         * @param mode Reduction of each block (default is the mean).
+         */
+        void heatmap(size_t height = 24, size_t width = 80, io::heatmap_mode mode = io::heatmap_mode::mean) const;
 
         // Determinate
         /**
         * @brief Calculate the determinant of the square tensor.
         *
-        * @return The determinant of the tensor.
+        * @details
+        * Uses a blocked LU factorization with partial pivoting, O(n^3). The factorization is cached, so det(),
+        * logDet() and minor() share it until the tensor is modified. The result is exactly 0 only when elimination
+        * meets an exactly zero pivot: a floating-point matrix that is singular in exact arithmetic usually gives a
+        * value at rounding level instead (about 6.7e-16 for [[1, 2, 3], [4, 5, 6], [7, 8, 9]]), so compare |det| to a
+        * tolerance scaled to the matrix rather than to 0. Integer tensors are factorized in double and the result is
+        * rounded to the nearest integer, which gives 0 for singular integer matrices of moderate size.
+        *
+        * @return The determinant of the tensor (1 for a 0x0 tensor).
+        * @throws NotSquareException If the tensor is not square.
         */
         type det();
 
+        // Log-determinant
+        /**
+        * @brief Calculate log|det| of the square tensor, which does not overflow where det() would.
+        *
+        * @param sign If not null, receives the sign of the determinant: -1, 1, or 0 when a pivot is exactly zero.
+        * @return The natural logarithm of the absolute determinant, -infinity when a pivot is exactly zero.
+        * @throws NotSquareException If the tensor is not square.
+        */
+        double logDet(int *sign = nullptr);
+
         // Element-wise application
         /**
          * @brief Applies an element-wise operation to each element of the tensor.
@@ -245,13 +531,34 @@ namespace tns {
          *
          * @tparam Function The unary function to be applied element-wise.
          * @param func The unary function taking a single argument and returning the result.
-         * @return A new tensor resulting from applying the element-wise operation.
+         * @return A lazy expression, evaluated on assignment to a tensor or by eval().
+         */
+        template<typename Function>
+        auto elementWise(Function func) const & {
+            return expr::map<expr::leaf<type>, Function>(expr::leaf<type>(*this), std::move(func));
+        }
+
+        template<typename Function>
+        auto elementWise(Function func) && {
+            return expr::map<expr::owned<type>, Function>(expr::owned<type>(std::move(*this)), std::move(func));
+        }
+
+        // In-place element-wise application
+        /**
+         * @brief Applies a unary function to each element of the tensor, in place.
+         *
+         * Same as `X = X.elementWise(func)`, without building an expression. The function is inlined into the
+         * loop, so simple functions such as ReLU are vectorized.
+         *
+         * @tparam Function The unary function to be applied element-wise.
+         * @param func The unary function taking a single argument and returning the result.
+         * @return Reference to this tensor.
          */
         template<typename Function>
-        tensor elementWise(Function func) const {
-            return applyOperation(0,
-                                  [func](type x, type /*num*/) { return func(x); }
-            );
+        tensor &apply(Function func) {
+            kernel::transformInPlace(_data, size(), std::move(func));
+            invalidateCache();
+            return *this;
         }
 
         // Element-wise function
@@ -268,12 +575,20 @@ namespace tns {
          * @brief Performs a binary-wise operation, also known as the Hadamard product, with another tensor.
          *
          * This method multiplies each corresponding element of the current tensor with the corresponding
-         * element of the given tensor, resulting in a new tensor of the same dimensions.
+         * element of the given tensor (or expression), resulting in a tensor of the same dimensions.
          *
          * @param rhs_tensor The tensor to perform the binary-wise operation with.
-         * @return A new tensor representing the result of the binary-wise operation.
+         * @return A lazy expression, evaluated on assignment to a tensor or by eval().
          */
-        tensor multiply(const tensor<type> &rhs_tensor) const;
+        template<typename Rhs>
+        auto multiply(Rhs &&rhs_tensor) const & {
+            return expr::makeBinary<expr::mul_op>(*this, std::forward<Rhs>(rhs_tensor));
+        }
+
+        template<typename Rhs>
+        auto multiply(Rhs &&rhs_tensor) && {
+            return expr::makeBinary<expr::mul_op>(std::move(*this), std::forward<Rhs>(rhs_tensor));
+        }
 
         // Create a matrix by removing row=i, col=j
         /**
@@ -282,6 +597,9 @@ namespace tns {
          * This method creates a new matrix by excluding the specified row (indexed by i) and column
          * (indexed by j) from the current matrix. The resulting matrix is of reduced size.
          *
+         * The minor is obtained from the cached LU factorization of the whole matrix in O(n^2), as
+         * `(-1)^(i+j) * det * inverse(j, i)`. A singular matrix falls back to the determinant of subTensor(i, j).
+         *
          * @param i The index of the row to be removed. It must satisfy the condition 0 <= i < MAX_ROWS.
          * @param j The index of the column to be removed. It must satisfy the condition 0 <= j < MAX_COLS.
          * @return The minor matrix without the specified row and column.
@@ -292,12 +610,16 @@ namespace tns {
         /**
          * @brief Computes the transpose of the current tensor.
          *
-         * This method returns a new tensor where the rows and columns of the original tensor are swapped.
-         * The resulting tensor has dimensions opposite to the original tensor.
+         * This method returns a view where the rows and columns of the original tensor are swapped, in O(1): the
+         * strides are swapped, the elements are not moved. A tensor of higher rank has all its dimensions reversed.
+         * Assigning it to a tensor copies it with a cache-blocked transposition, and `X.T() * Y` multiplies without
+         * copying. Like every view, it cannot be taken of a temporary tensor.
          *
-         * @return The transposed tensor.
+         * @return The transposed view.
          */
-        tensor T();
+        tensor_view<type> T() const &;
+
+        tensor_view<type> T() const && = delete;
 
         // Getting the sub-tensor from original tensor by removing the row (i) and col (j)
         /**
@@ -341,90 +663,400 @@ namespace tns {
          * number of rows and columns to read from the file. The precision parameter determines the precision of the
          * numbers in the CSV file (default is 5).
          *
+         * @details
+         * The file is memory-mapped and parsed in parallel with std::from_chars straight into the tensor buffer
+         * (see IO/csv.h).
+         *
          * @param filename The name of the CSV file.
          * @param MAX_ROWS The maximum number of tensor row.
          * @param MAX_COLS The maximum number of tensor column.
-         * @param precision The precision of the numbers in the CSV file (default is 5).
+         * @param precision The precision of the numbers in the CSV file (default is 5), negative to keep the values
+         * as parsed.
+         * @param stats If not null, receives the size of the file and the time (and MB/s) of each stage.
          * @return The tensor read from the CSV file.
+         * @throws std::runtime_error If the file cannot be opened.
+         * @throws std::invalid_argument If a cell is not a number (the message gives its line and column).
          *
          * @note If the file has fewer rows or columns than specified by MAX_ROWS or MAX_COLS, the remaining elements
          * will be set to 0. If the file contains more rows or columns, excess data will be ignored.
-         * Malformed or incomplete CSV files may result in unexpected behavior.
          */
         static tensor<type>
-        read_csv(const std::string &filename, const int &MAX_ROWS, const int &MAX_COLS, int precision = 5);
+        read_csv(const std::string &filename, const int &MAX_ROWS, const int &MAX_COLS, int precision = 5,
+                 io::csv_stats *stats = nullptr);
+
+        /**
+         * @brief Reads a tensor from a CSV file whose shape is not known in advance.
+         *
+         * The number of rows is the number of non-blank data lines, and the number of columns the width of the
+         * header or of the first line, or the number of selected columns.
+         *
+         * @details
+         * The file is memory-mapped and every line-aligned chunk is parsed once, in parallel, into a buffer that
+         * grows geometrically; the chunks are then copied into the tensor (see io::loadCsv()).
+         *
+         * With options.cache, the result is also written to filename + ".tnscache", keyed by the size and
+         * modification time of the file, the element type and the parse options. Later calls with the same options
+         * map that cache instead of parsing, until the file changes (see IO/csv_cache.h); the returned tensor then
+         * borrows the mapped cache (see mapped()).
+         *
+         * @param filename The name of the CSV file.
+         * @param options Header, column selection, expected number of rows, precision and error policy.
+         * @param report If not null, receives the header, the skipped lines and the size and timing of each stage.
+         * @return The tensor read from the CSV file.
+         * @throws std::runtime_error If the file cannot be opened.
+         * @throws std::invalid_argument On a ragged or malformed line (the message gives its line number) unless
+         * options.skipBadLines is set, or if a selected column does not exist.
+         */
+        static tensor<type>
+        read_csv(const std::string &filename, const io::csv_options &options = {}, io::csv_report *report = nullptr);
+
+        /**
+         * @brief Writes the tensor to a CSV file, one line per row, without colors or padding.
+         *
+         * @details
+         * Numbers are formatted with std::to_chars, row chunks in parallel, and written in order with large writes
+         * (see io::writeCsv()). With the default precision, read_csv() gives back exactly the same values.
+         *
+         * @param filename The name of the CSV file, replaced if it exists.
+         * @param precision Number of decimals, or -1 for the shortest text that reads back to the same value.
+         * Ignored for tensor<int>.
+         * @param header Column names written as the first line if not empty.
+         * @throws std::invalid_argument If header is not empty and does not name every column.
+         * @throws std::runtime_error If the file cannot be written.
+         */
+        void write_csv(const std::string &filename, int precision = -1,
+                       const std::vector<std::string> &header = {}) const;
+
+        // NumPy files
+        /**
+         * @brief Reads a tensor from a NumPy .npy file.
+         *
+         * A 2-D array gives a (rows x cols) tensor, a 1-D array of n elements a (n x 1) tensor and a scalar a (1 x 1)
+         * tensor; arrays of 3 or more dimensions keep their shape. Booleans, integers and floating-point numbers of any size and byte order are converted to type.
+         *
+         * @details
+         * With map set, a C-order file whose elements already are of type (see io::npyDescr()) is not copied: the
+         * tensor borrows the memory-mapped payload, and the file stays mapped as long as the tensor or one moved from
+         * it lives. The mapping is copy-on-write, so writing to the tensor never modifies the file. Other files,
+         * and any file when map is false, are converted into a new buffer.
+         *
+         * @param filename The name of the .npy file.
+         * @param map Borrow the mapped payload when possible (default is true).
+         * @return The tensor read from the file.
+         * @throws std::runtime_error If the file cannot be opened.
+         * @throws std::invalid_argument If the file is not a valid .npy file, is truncated, has more than
+         * tensor_shape::max_rank dimensions or an unsupported element type.
+         */
+        static tensor<type> read_npy(const std::string &filename, bool map = true);
+
+        /**
+         * @brief Writes the tensor to a NumPy .npy file (format 1.0, C order, elements of type, with its shape()),
+         * readable with `numpy.load`.
+         *
+         * @param filename The name of the .npy file.
+         * @throws std::runtime_error If the file cannot be written.
+         */
+        void write_npy(const std::string &filename) const;
 
     private:
         /**
-        * @brief Update the minimum and maximum values of the tensor.
+        * @brief Wrap elements owned by owner, without copying them.
+        */
+        tensor(type *data, size_t rows, size_t cols, std::shared_ptr<const void> owner);
+
+        /**
+        * @brief Buffer for count elements: the inline one when they fit in it, a new allocation otherwise.
+        */
+        type *acquireBuffer(size_t count) {
+            return (count != 0 && count <= storage::SMALL_SIZE) ? _inline.data() : storage::allocate<type>(count);
+        }
+
+        /**
+        * @brief Release the buffer: deallocate it if owned, drop the reference to its owner otherwise.
+        */
+        void releaseBuffer();
+
+        /**
+        * @brief Take over the buffer and row table of other, copying the elements of an inline buffer.
+        */
+        void takeBuffer(tensor &other) noexcept;
+
+        /**
+        * @brief Give the tensor a shape of size() elements, and the contiguous strides of its matrix form.
+        */
+        void setShape(const tensor_shape &shape);
+
+        /**
+        * @brief Access the element at (i, j) without bound checking.
+        */
+        type &at(size_t i, size_t j) { return _data[i * _rowStride + j * _colStride]; }
+
+        const type &at(size_t i, size_t j) const { return _data[i * _rowStride + j * _colStride]; }
+
+        /**
+        * @brief Mark the cached minimum, maximum and LU factorization as stale, after the elements were modified.
+        */
+        void invalidateCache() const {
+            _minMaxDirty.store(true, std::memory_order_relaxed);
+            _lu.reset();
+        }
+
+        /**
+        * @brief Take the cached minimum and maximum of other when they are up to date, or mark them stale.
         *
-        * @param value The value to compare and update the minimum and maximum values.
+        * A stale cache of other may be published by a concurrent reader, so its values are read only once the flag
+        * is seen clear.
         */
-        void updateMinMaxValues(type value);
+        void copyMinMax(const tensor<type> &other) {
+            const bool dirty = other._minMaxDirty.load(std::memory_order_acquire);
+            if (!dirty) {
+                _minValue = other._minValue;
+                _maxValue = other._maxValue;
+            }
+            _minMaxDirty.store(dirty, std::memory_order_relaxed);
+        }
+
+        /**
+        * @brief Recompute the cached minimum and maximum if they are stale, with a SIMD reduction (parallel on large
+        * tensors).
+        */
+        void updateMinMax() const;
+
+        /**
+        * @brief Get the cached LU factorization, computing it if needed.
+        *
+        * @throws NotSquareException If the tensor is not square.
+        */
+        const kernel::lu_factors<lu_type> &factorization() const;
 
         /**
-        * @brief Apply a binary operation to the tensor.
+        * @brief Evaluate an expression of the same size into the buffer, then refresh the minimum and maximum.
+        */
+        template<typename Derived>
+        void evaluate(const Derived &expression);
+
+        /**
+        * @brief Evaluate an expression of the shape of this tensor into it, for the compound assignments.
         *
-        * @param num The scalar operand.
-        * @param operation The binary operation to be applied.
-        * @return A new tensor with the result of the binary operation.
+        * @throws ShapeMismatchException If the expression broadcasts to another shape (e.g. `row += matrix`).
         */
-        tensor<type> applyOperation(type num, std::function<type(type, type)> operation) const;
+        template<typename Derived>
+        tensor &evaluateInPlace(const Derived &expression);
+
+        /**
+        * @brief Evaluate an expression holding views, or broadcasting, row by row. A view reading this buffer is evaluated into a new
+        * buffer first, since it may read elements already overwritten (e.g. `X = X.T()`).
+        */
+        template<typename Derived>
+        void evaluateStrided(const Derived &expression);
 
     };
 
 } // tns
 
-template<typename type>
-tns::tensor<type> operator+(type num, const tns::tensor<type> &tensor) {
-    return tensor + num;
-}
+namespace tns {
 
-template<typename type>
-tns::tensor<type> operator-(type num, const tns::tensor<type> &tensor) {
-    return tensor - num;
-}
+    template<typename type>
+    template<typename Derived>
+    tensor<type>::tensor(const expression<Derived> &expression)
+            : _shape(expression.self().shape()), _rows(_shape.rows()), _cols(_shape.cols()), _rowStride(_cols) {
+        _data = acquireBuffer(_rows * _cols);
+        evaluate(expression.self());
+    }
 
-template<typename type>
-tns::tensor<type> operator*(type num, const tns::tensor<type> &tensor) {
-    return tensor * num;
-}
+    template<typename type>
+    template<typename Derived>
+    tensor<type> &tensor<type>::operator=(const expression<Derived> &expression) {
+        const Derived &source = expression.self();
 
-template<typename type>
-tns::tensor<type> operator/(type num, const tns::tensor<type> &tensor) {
-    return tensor / num;
-}
+        // A view of this tensor (e.g. `X = X.slice(0, 2, 0, 2)`) may not have its size: evaluate it before releasing
+        if constexpr (Derived::is_strided) {
+            if (source.overlaps(_data, _data + size())) {
+                return *this = tensor<type>(source);
+            }
+        }
 
-template<typename type>
-std::ostream &operator<<(std::ostream &COUT, tns::tensor<type> &tensor) {
-    const auto &tns = tensor.pTensor();
-    const type min = tensor.min();
-    const type max = tensor.max();
-    const int row = tensor.row();
-    const int col = tensor.col();
-    const int precision = static_cast<int>(std::cout.precision());
-    const float delta = (max - min > 0) ? (max - min) / 7.0 : 1.0;
-
-    // including space(2), sign+-(1), decimal and dot(0 or 4)
-    int k = (std::is_same<type, int>::value) ? 3 : (4 + precision);
-    k -= (min > 0);
-
-    type numBeforeDot = std::max(std::abs(max), std::abs(min));
-    type digits = std::log10(std::max(numBeforeDot, static_cast<type>(1))) + 1; // number before dot
-
-    int width = static_cast<int>(digits + k);
-    COUT << std::setprecision(precision) << std::fixed;
-
-    for (int i = 0; i < row; ++i) {
-        for (int j = 0; j < col; ++j) {
-            COUT << color::getColorConstant(round((tns[i][j] - min) / delta))
-                 << std::setw(width) << tns[i][j] << color::RESET;
+        // An expression reading this tensor without broadcasting it has its size, so the buffer is never replaced
+        // under it. Borrowed elements are replaced too, like in the copy assignment.
+        if (size() != source.row() * source.col() || _owner) {
+            return *this = tensor<type>(source);
+        }
+        setShape(source.shape());
+
+        evaluate(source);
+        return *this;
+    }
+
+    template<typename type>
+    template<typename Derived>
+    void tensor<type>::evaluate(const Derived &expression) {
+        // Elements of a broadcast operand are not at their linear index, the rows are evaluated one by one
+        if (expression.broadcasting()) {
+            evaluateStrided(expression);
+        } else if constexpr (expr::simd_binary<Derived>) {
+            const auto kernel = simd::kernels<type>().*(Derived::op_type::template binaryKernel<type>);
+            const type *lhs = expression.lhs.data(), *rhs = expression.rhs.data();
+            parallel::forEachChunk(size(), [&](size_t begin, size_t end) {
+                kernel(lhs + begin, rhs + begin, _data + begin, end - begin);
+            });
+        } else if constexpr (expr::simd_scalar<Derived>) {
+            const auto kernel = simd::kernels<type>().*(Derived::op_type::template scalarKernel<type>);
+            const type *lhs = expression.lhs.data(), num = expression.rhs.value;
+            parallel::forEachChunk(size(), [&](size_t begin, size_t end) {
+                kernel(lhs + begin, num, _data + begin, end - begin);
+            });
+        } else if constexpr (expr::dense_map<Derived>) {
+            const type *source = expression.arg.data();
+            if (source == _data) {
+                kernel::transformInPlace(_data, size(), expression.func);
+            } else {
+                kernel::transform(source, _data, size(), expression.func);
+            }
+        } else if constexpr (Derived::is_strided) {
+            evaluateStrided(expression);
+        } else {
+            // The whole expression tree is inlined into this loop: one read of each operand, one write
+            type *out = _data;
+            parallel::forEachChunk(size(), [&](size_t begin, size_t end) {
+                for (size_t k = begin; k < end; ++k) {
+                    out[k] = expression[k];
+                }
+            });
+        }
+
+        invalidateCache();
+    }
+
+    template<typename type>
+    template<typename Derived>
+    void tensor<type>::evaluateStrided(const Derived &expression) {
+        if (expression.overlaps(_data, _data + size())) {
+            const tensor<type> result(expression);
+            std::copy_n(result._data, size(), _data);
+            return;
+        }
+
+        if constexpr (std::is_same_v<Derived, tensor_view<type>>) {
+            kernel::copyStrided(expression.data(), expression.shape(), expression.strides(), _data);
+        } else {
+            auto evaluateRows = [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    expr::evaluateRow(expression, i, _cols, _data + i * _cols);
+                }
+            };
+            if (size() < parallel::threshold() || parallel::threadCount() <= 1) {
+                evaluateRows(0, _rows);
+            } else {
+                parallel::parallelFor(0, _rows, std::max<size_t>(1, parallel::threshold() / _cols), evaluateRows);
+            }
+        }
+    }
+
+    template<typename type>
+    template<typename Derived>
+    tensor<type> &tensor<type>::evaluateInPlace(const Derived &expression) {
+        if (expression.shape() != _shape) {
+            std::ostringstream message;
+            message << "\nMatrix shape mismatch (" << Derived::op_type::name << " in place): " << _shape
+                    << " cannot hold the broadcast result " << expression.shape();
+            throw ShapeMismatchException(message.str(), _rows, _cols, expression.row(), expression.col());
         }
-        COUT << '\n';
+        evaluate(expression);
+        return *this;
+    }
+
+    template<typename type>
+    template<typename Rhs> requires expr::is_operand_v<Rhs>
+    tensor<type> &tensor<type>::operator+=(Rhs &&rhs) {
+        return evaluateInPlace(expr::makeBinary<expr::add_op>(*this, std::forward<Rhs>(rhs)));
+    }
+
+    template<typename type>
+    template<typename Rhs> requires expr::is_operand_v<Rhs>
+    tensor<type> &tensor<type>::operator-=(Rhs &&rhs) {
+        return evaluateInPlace(expr::makeBinary<expr::sub_op>(*this, std::forward<Rhs>(rhs)));
+    }
+
+    template<typename type>
+    template<typename Rhs> requires expr::is_scalar_v<Rhs>
+    tensor<type> &tensor<type>::operator*=(Rhs num) {
+        evaluate(expr::makeBinary<expr::mul_op>(*this, num));
+        return *this;
+    }
+
+    template<typename type>
+    template<typename Rhs> requires expr::is_operand_v<Rhs>
+    tensor<type> &tensor<type>::operator/=(Rhs &&rhs) {
+        return evaluateInPlace(expr::makeBinary<expr::div_op>(*this, std::forward<Rhs>(rhs)));
+    }
+
+// Output-parameter variants: out keeps its buffer when the size matches, so loops that reuse out never allocate
+    /**
+     * @brief out = lhs + rhs, element-wise. out may be one of the operands.
+     *
+     * @throws ShapeMismatchException If the array operands have shapes that do not broadcast.
+     */
+    template<typename type, typename L, typename R> requires expr::elementwise_operands<L, R>
+    void add(L &&lhs, R &&rhs, tensor<type> &out) {
+        out = std::forward<L>(lhs) + std::forward<R>(rhs);
+    }
+
+    /**
+     * @brief out = lhs - rhs, element-wise. out may be one of the operands.
+     *
+     * @throws ShapeMismatchException If the array operands have shapes that do not broadcast.
+     */
+    template<typename type, typename L, typename R> requires expr::elementwise_operands<L, R>
+    void subtract(L &&lhs, R &&rhs, tensor<type> &out) {
+        out = std::forward<L>(lhs) - std::forward<R>(rhs);
     }
 
-//    std::cout << std::setw(0) << std::setfill(' ') << std::setprecision(6);
+    /**
+     * @brief out = lhs * rhs, element-wise (Hadamard product, or scaling by a scalar). out may be one of the
+     * operands.
+     *
+     * @throws ShapeMismatchException If the array operands have shapes that do not broadcast.
+     */
+    template<typename type, typename L, typename R> requires expr::elementwise_operands<L, R>
+    void multiply(L &&lhs, R &&rhs, tensor<type> &out) {
+        out = expr::makeBinary<expr::mul_op>(std::forward<L>(lhs), std::forward<R>(rhs));
+    }
+
+    /**
+     * @brief out = lhs / rhs, element-wise. out may be one of the operands.
+     *
+     * @throws ShapeMismatchException If the array operands have shapes that do not broadcast.
+     */
+    template<typename type, typename L, typename R> requires expr::elementwise_operands<L, R>
+    void divide(L &&lhs, R &&rhs, tensor<type> &out) {
+        out = std::forward<L>(lhs) / std::forward<R>(rhs);
+    }
 
+    /**
+     * @brief out = alpha * lhs * rhs + beta * out (matrix multiplication), written straight into out.
+     *
+     * @details
+     * With beta = 0, out is resized to (lhs.row(), rhs.col()) if needed (no allocation when it already has that
+     * size) and its previous content is ignored. With beta != 0, out must already have that shape.
+     *
+     * @param lhs Left matrix.
+     * @param rhs Right matrix.
+     * @param out Destination, must not be lhs or rhs.
+     * @param alpha Scale of the product.
+     * @param beta Scale of the previous content of out.
+     * @throws ShapeMismatchException If lhs.col() != rhs.row(), or beta != 0 and out has the wrong shape.
+     * @throws std::invalid_argument If out is lhs or rhs.
+     */
+    template<typename type>
+    void gemm(const tensor<type> &lhs, const tensor<type> &rhs, tensor<type> &out,
+              std::type_identity_t<type> alpha = 1, std::type_identity_t<type> beta = 0);
+
+} // tns
+
+template<typename type>
+std::ostream &operator<<(std::ostream &COUT, const tns::tensor<type> &tensor) {
+    tns::io::printTensor(COUT, tensor.data().data(), tensor.row(), tensor.col(), tensor.rowStride(),
+                         tensor.colStride(), tensor.min(), tensor.max(), static_cast<int>(COUT.precision()), true);
     return COUT;
 }
 
@@ -11,35 +11,34 @@
  */
 
 #include "tensor.h"
+#include "Kernel/simd.h"
+#include "Parallel/thread_pool.h"
+
+#include <mutex>
+#include <vector>
 
 namespace tns {
 
 // Constructors
     template<typename type>
     tensor<type>::tensor()
-            : _rows(1), _cols(1), _maxValue(0), _minValue(0) {
-        _tns = new type *[1];
-        _tns[0] = new type[0];
-        _tns[0][0] = 0;
+            : _shape{1, 1}, _rows(1), _cols(1), _rowStride(1), _maxValue(0), _minValue(0), _minMaxDirty(false) {
+        _data = acquireBuffer(1);
+        _data[0] = 0;
     }
 
     template<typename type>
     tensor<type>::tensor(size_t rows, size_t cols, type initData)
-            : _rows(rows), _cols(cols), _maxValue(initData), _minValue(initData) {
-
-        _tns = new type *[rows];
+            : _shape{rows, cols}, _rows(rows), _cols(cols), _rowStride(cols), _maxValue(initData), _minValue(initData),
+              _minMaxDirty(rows * cols == 0) {
 
-        for (int i = 0; i < rows; ++i) {
-            _tns[i] = new type[cols];
-            for (int j = 0; j < cols; ++j) {
-                _tns[i][j] = initData;
-            }
-        }
+        _data = acquireBuffer(rows * cols);
+        std::fill_n(_data, rows * cols, initData);
     }
 
     template<typename type>
     tensor<type>::tensor(size_t rows, size_t cols, type minRange, type maxRange)
-            : _rows(rows), _cols(cols) {
+            : _shape{rows, cols}, _rows(rows), _cols(cols), _rowStride(cols) {
 
         std::random_device rd;
         std::mt19937 gen(rd());
@@ -49,41 +48,116 @@ namespace tns {
                 std::uniform_real_distribution<type>
         >(minRange, maxRange);
 
-        type temp;
-        _tns = new type *[rows];
+        _data = acquireBuffer(rows * cols);
 
-        for (int i = 0; i < rows; ++i) {
-            _tns[i] = new type[cols];
-            for (int j = 0; j < cols; ++j) {
-                temp = uniform(gen);
-                _tns[i][j] = temp;
-                updateMinMaxValues(temp);
-            }
+        for (size_t k = 0; k < rows * cols; ++k) {
+            _data[k] = uniform(gen);
         }
 
     }
 
     template<typename type>
     tensor<type>::tensor(type *array, size_t rows, size_t cols)
-            : _rows(rows), _cols(cols) {
+            : _shape{rows, cols}, _rows(rows), _cols(cols), _rowStride(cols) {
 
-        _tns = new type *[rows];
-        type temp;
+        _data = acquireBuffer(rows * cols);
+        std::copy_n(array, rows * cols, _data);
+    }
 
-        for (int i = 0; i < rows; ++i) {
-            _tns[i] = new type[cols];
-            for (int j = 0; j < cols; ++j) {
-                temp = array[cols * i + j];
-                updateMinMaxValues(temp);
-                _tns[i][j] = temp;
-            }
+    template<typename type>
+    tensor<type>::tensor(const tensor_shape &shape, type initData)
+            : tensor(shape.rows(), shape.cols(), initData) {
+        _shape = shape;
+    }
+
+    template<typename type>
+    tensor<type>::tensor(type *data, size_t rows, size_t cols, std::shared_ptr<const void> owner)
+            : _shape{rows, cols}, _rows(rows), _cols(cols), _rowStride(cols), _data(data), _owner(std::move(owner)) {}
+
+// Copy and move
+    template<typename type>
+    tensor<type>::tensor(const tensor<type> &other)
+            : _shape(other._shape), _rows(other._rows), _cols(other._cols), _rowStride(other._cols) {
+
+        copyMinMax(other);
+        _data = acquireBuffer(_rows * _cols);
+        std::copy_n(other._data, size(), _data);
+    }
+
+    template<typename type>
+    tensor<type>::tensor(tensor<type> &&other) noexcept
+            : _shape(other._shape), _rows(other._rows), _cols(other._cols), _rowStride(other._rowStride),
+              _colStride(other._colStride),
+              _maxValue(other._maxValue), _minValue(other._minValue), _minMaxDirty(other._minMaxDirty.load()),
+              _lu(std::move(other._lu)), _owner(std::move(other._owner)) {
+
+        takeBuffer(other);
+        other._shape = tensor_shape::matrix(0, 0);
+        other._rows = other._cols = other._rowStride = 0;
+        other._colStride = 1;
+    }
+
+    template<typename type>
+    tensor<type> &tensor<type>::operator=(const tensor<type> &other) {
+        if (this == &other) {
+            return *this;
+        }
+
+        // Borrowed elements are released too: the copy owns its elements, and never writes into a mapped file
+        if (size() != other.size() || _owner) {
+            releaseBuffer();
+            _data = acquireBuffer(other.size());
         }
+        delete[] _rowTable;
+        _rowTable = nullptr;
 
+        _shape = other._shape;
+        _rows = other._rows;
+        _cols = other._cols;
+        _rowStride = other._cols;
+        _colStride = 1;
+        copyMinMax(other);
+        _lu.reset();
+
+        std::copy_n(other._data, size(), _data);
+
+        return *this;
+    }
+
+    template<typename type>
+    tensor<type> &tensor<type>::operator=(tensor<type> &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        releaseBuffer();
+        delete[] _rowTable;
+
+        _shape = other._shape;
+        _rows = other._rows;
+        _cols = other._cols;
+        _rowStride = other._rowStride;
+        _colStride = other._colStride;
+        _maxValue = other._maxValue;
+        _minValue = other._minValue;
+        _minMaxDirty = other._minMaxDirty.load();
+        _lu = std::move(other._lu);
+        _owner = std::move(other._owner);
+
+        takeBuffer(other);
+        other._shape = tensor_shape::matrix(0, 0);
+        other._rows = other._cols = other._rowStride = 0;
+        other._colStride = 1;
+
+        return *this;
     }
 
 // Destructor
     template<typename type>
-    tensor<type>::~tensor() = default;
+    tensor<type>::~tensor() {
+        releaseBuffer();
+        delete[] _rowTable;
+    }
 
 // Getter, Setter
     template<typename type>
@@ -96,31 +170,215 @@ namespace tns {
         return _cols;
     }
 
+    template<typename type>
+    const tensor_shape &tensor<type>::shape() const {
+        return _shape;
+    }
+
+    template<typename type>
+    size_t tensor<type>::ndim() const {
+        return _shape.rank();
+    }
+
     template<typename type>
     type tensor<type>::max() const {
+        updateMinMax();
         return _maxValue;
     }
 
     template<typename type>
     type tensor<type>::min() const {
+        updateMinMax();
         return _minValue;
     }
 
+    template<typename type>
+    size_t tensor<type>::size() const {
+        return _rows * _cols;
+    }
+
+    template<typename type>
+    size_t tensor<type>::rowStride() const {
+        return _rowStride;
+    }
+
+    template<typename type>
+    size_t tensor<type>::colStride() const {
+        return _colStride;
+    }
+
+    template<typename type>
+    std::span<type> tensor<type>::data() {
+        invalidateCache();
+        return {_data, _rows * _cols};
+    }
+
+    template<typename type>
+    std::span<const type> tensor<type>::data() const {
+        return {_data, _rows * _cols};
+    }
+
     template<typename type>
     type **tensor<type>::pTensor() const {
-        return _tns;
+        // The table gives write access to the elements
+        invalidateCache();
+        if (_rowTable == nullptr) {
+            _rowTable = new type *[_rows];
+            for (size_t i = 0; i < _rows; ++i) {
+                _rowTable[i] = _data + i * _rowStride;
+            }
+        }
+        return _rowTable;
+    }
+
+    template<typename type>
+    bool tensor<type>::mapped() const {
+        return _owner != nullptr;
+    }
+
+// Shape
+    template<typename type>
+    tensor<type> &tensor<type>::reshape(const tensor_shape &shape) & {
+        setShape(shape.resolved(size()));
+        return *this;
+    }
+
+    template<typename type>
+    tensor<type> &tensor<type>::squeeze() & {
+        tensor_shape squeezed;
+        for (size_t dim: _shape) {
+            if (dim != 1) {
+                squeezed = squeezed.inserted(squeezed.rank(), dim);
+            }
+        }
+        setShape(squeezed);
+        return *this;
+    }
+
+    template<typename type>
+    tensor<type> &tensor<type>::squeeze(size_t axis) & {
+        if (axis >= _shape.rank() || _shape[axis] != 1) {
+            std::ostringstream message;
+            message << "\nInvalid axis (tns::tensor::squeeze()): axis " << axis << " of shape " << _shape
+                    << " is not of size 1";
+            throw std::invalid_argument(message.str());
+        }
+        setShape(_shape.erased(axis));
+        return *this;
+    }
+
+    template<typename type>
+    tensor<type> &tensor<type>::unsqueeze(size_t axis) & {
+        if (axis > _shape.rank() || _shape.rank() == tensor_shape::max_rank) {
+            std::ostringstream message;
+            message << "\nInvalid axis (tns::tensor::unsqueeze()): axis " << axis << " of shape " << _shape;
+            throw std::invalid_argument(message.str());
+        }
+        setShape(_shape.inserted(axis, 1));
+        return *this;
     }
 
 // Private method
-    // Update the private minValue and maxValue
     template<typename type>
-    void tensor<type>::updateMinMaxValues(type value) {
-        if (_maxValue < value) {
-            _maxValue = value;
+    void tensor<type>::setShape(const tensor_shape &shape) {
+        // The row table may point into a replaced buffer, and the LU factorization describes the old matrix form
+        delete[] _rowTable;
+        _rowTable = nullptr;
+        if (shape.rows() != _rows || shape.cols() != _cols) {
+            _lu.reset();
         }
-        if (_minValue > value) {
-            _minValue = value;
+
+        _shape = shape;
+        _rows = shape.rows();
+        _cols = shape.cols();
+        _rowStride = _cols;
+        _colStride = 1;
+    }
+
+    template<typename type>
+    void tensor<type>::releaseBuffer() {
+        if (_owner) {
+            _owner.reset();
+        } else if (_data != _inline.data()) {
+            storage::deallocate(_data, size());
         }
+        _data = nullptr;
+    }
+
+    template<typename type>
+    void tensor<type>::takeBuffer(tensor<type> &other) noexcept {
+        if (other._data != nullptr && other._data == other._inline.data()) {
+            // The inline buffer moves with the object: copy its elements, the row table points into other
+            _data = _inline.data();
+            std::copy_n(other._data, other.size(), _data);
+            delete[] other._rowTable;
+            _rowTable = nullptr;
+        } else {
+            _data = other._data;
+            _rowTable = other._rowTable;
+        }
+        other._data = nullptr;
+        other._rowTable = nullptr;
+    }
+
+    // Recompute minValue and maxValue if an operation modified the elements since the last call
+    template<typename type>
+    void tensor<type>::updateMinMax() const {
+        if (!_minMaxDirty.load(std::memory_order_acquire) || size() == 0) {
+            return;
+        }
+
+        // The reduction runs without _minMaxMutex: a thread waiting in parallelFor executes other queued chunks, and
+        // one of them may read the minimum of this very tensor
+        const auto minMax = simd::kernels<type>().minMax;
+        std::mutex merge;
+        type minValue = _data[0], maxValue = _data[0];
+
+        parallel::forEachChunk(size(), [&](size_t begin, size_t end) {
+            type localMin, localMax;
+            minMax(_data + begin, end - begin, &localMin, &localMax);
+
+            std::lock_guard<std::mutex> lock(merge);
+            minValue = std::min(minValue, localMin);
+            maxValue = std::max(maxValue, localMax);
+        });
+
+        // Readers only touch the values once the flag is clear, so the first thread to publish wins
+        std::lock_guard<std::mutex> publish(_minMaxMutex);
+        if (_minMaxDirty.load(std::memory_order_relaxed)) {
+            _minValue = minValue;
+            _maxValue = maxValue;
+            _minMaxDirty.store(false, std::memory_order_release);
+        }
+    }
+
+    // Factorize on first use after a modification
+    template<typename type>
+    const kernel::lu_factors<typename tensor<type>::lu_type> &tensor<type>::factorization() const {
+        if (_rows != _cols) {
+            std::ostringstream message;
+            message << "Matrix shape mismatch (LU factorization): (" << _rows << ", " << _cols
+                    << ") is not a square matrix";
+            throw NotSquareException(message.str(), _rows, _cols);
+        }
+
+        if (!_lu) {
+            auto factors = std::make_unique<kernel::lu_factors<lu_type>>();
+            if constexpr (std::is_same_v<type, lu_type>) {
+                kernel::luFactorize<lu_type>(_rows, _data, _rowStride, _colStride, *factors);
+            } else {
+                std::vector<lu_type> converted(size());
+                for (size_t i = 0; i < _rows; ++i) {
+                    for (size_t j = 0; j < _cols; ++j) {
+                        converted[i * _cols + j] = static_cast<lu_type>(at(i, j));
+                    }
+                }
+                kernel::luFactorize<lu_type>(_rows, converted.data(), _cols, 1, *factors);
+            }
+            _lu = std::move(factors);
+        }
+
+        return *_lu;
     }
 }
 
@@ -3,6 +3,9 @@
 //
 
 #include "tensor.h"
+#include "Kernel/gemm.h"
+
+#include <stdexcept>
 
 namespace tns {
 // Overload operators
@@ -16,12 +19,12 @@ namespace tns {
             throw OutOfRangeException(message.str(), _rows, _cols);
         }
 
-        return _tns[i][j];
+        return at(i, j);
     }
 
     // Getting column
     template<typename type>
-    tensor<type> tensor<type>::operator[](size_t j) const {
+    tensor_view<type> tensor<type>::operator[](size_t j) const & {
         if (j >= _cols) {
             std::ostringstream message;
             message << "\nMatrix out of range: Column[" << j << "] not belongs to matrix(" << _rows << ", " << _cols
@@ -29,159 +32,138 @@ namespace tns {
             throw OutOfRangeException(message.str(), _rows, _cols);
         }
 
-        tensor<type> result(_rows, 1);
+        return view().colView(j);
+    }
 
-        for (int i = 0; i < _rows; ++i) {
-            result._tns[i][0] = _tns[i][j];
-            result.updateMinMaxValues(_tns[i][j]);
-        }
+    // Views
+    template<typename type>
+    tensor_view<type> tensor<type>::view() const & {
+        return {_data, _shape, _shape.strides().data()};
+    }
 
-        return result;
+    template<typename type>
+    tensor_view<type> tensor<type>::colView(size_t j) const & {
+        return (*this)[j];
     }
 
-    // Matrix multiplication
     template<typename type>
-    tensor<type> tensor<type>::operator*(const tensor<type> &rhs_tensor) const {
-        if (_cols != rhs_tensor._rows) {
+    tensor_view<type> tensor<type>::rowView(size_t i) const & {
+        if (i >= _rows) {
             std::ostringstream message;
-            message << "\nMatrix shape mismatch (* matrix multiplication): (" << _rows << ", " << _cols << ") vs ("
-                    << rhs_tensor._rows << ", " << rhs_tensor._cols << ")";
-            throw ShapeMismatchException(message.str(), _rows, _cols, rhs_tensor._rows, rhs_tensor._cols);
+            message << "\nMatrix out of range: Row[" << i << "] not belongs to matrix(" << _rows << ", " << _cols
+                    << ")";
+            throw OutOfRangeException(message.str(), _rows, _cols);
         }
 
-        tensor<type> result(_rows, rhs_tensor._cols);
+        return view().rowView(i);
+    }
 
-        for (int i = 0; i < _rows; ++i) {
-            for (int j = 0; j < rhs_tensor._cols; ++j) {
-                type dotProduct = 0;
-                for (int k = 0; k < _cols; ++k) {
-                    dotProduct += _tns[i][k] * rhs_tensor._tns[k][j];
-                }
-                result._tns[i][j] = dotProduct;
-                result.updateMinMaxValues(dotProduct);
-            }
-        }
+    template<typename type>
+    tensor_view<type> tensor<type>::slice(size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd) const & {
+        return view().slice(rowBegin, rowEnd, colBegin, colEnd);
+    }
 
-        return result;
+    template<typename type>
+    tensor_view<type> tensor<type>::permute(const std::vector<size_t> &axes) const & {
+        return view().permute(axes);
     }
 
-    // Binary operation
+    // Matrix multiplication
     template<typename type>
-    tensor<type> tensor<type>::operator+(const tensor<type> &rhs_tensor) const {
-        if (_rows != rhs_tensor._rows || _cols != rhs_tensor._cols) {
+    tensor<type> tensor<type>::operator*(const tensor<type> &rhs_tensor) const {
+        if (_cols != rhs_tensor._rows) {
             std::ostringstream message;
-            message << "\nMatrix shape mismatch (+ element-wise addition): (" << _rows << ", " << _cols << ") vs ("
+            message << "\nMatrix shape mismatch (* matrix multiplication): (" << _rows << ", " << _cols << ") vs ("
                     << rhs_tensor._rows << ", " << rhs_tensor._cols << ")";
             throw ShapeMismatchException(message.str(), _rows, _cols, rhs_tensor._rows, rhs_tensor._cols);
         }
 
-        tensor<type> result(_rows, _cols);
-        type temp;
+        tensor<type> result(_rows, rhs_tensor._cols);
+
+        kernel::gemm<type>(_rows, rhs_tensor._cols, _cols, 1,
+                           _data, _rowStride, _colStride,
+                           rhs_tensor._data, rhs_tensor._rowStride, rhs_tensor._colStride,
+                           0, result._data, result._rowStride, result._colStride);
 
-        for (int i = 0; i < _rows; ++i) {
-            for (int j = 0; j < _cols; ++j) {
-                temp = _tns[i][j] + rhs_tensor._tns[i][j];
-                result.updateMinMaxValues(temp);
-                result._tns[i][j] = temp;
-            }
-        }
+        result.invalidateCache();
 
         return result;
     }
 
+// Matrix multiplication of views
     template<typename type>
-    tensor<type> tensor<type>::operator-(const tensor<type> &rhs_tensor) const {
-        if (_rows != rhs_tensor._rows || _cols != rhs_tensor._cols) {
+    tensor<type> matmul(const tensor_view<type> &lhs, const tensor_view<type> &rhs) {
+        if (lhs.col() != rhs.row()) {
             std::ostringstream message;
-            message << "\nMatrix shape mismatch (- element-wise subtraction): (" << _rows << ", " << _cols << ") vs ("
-                    << rhs_tensor._rows << ", " << rhs_tensor._cols << ")";
-            throw ShapeMismatchException(message.str(), _rows, _cols, rhs_tensor._rows, rhs_tensor._cols);
+            message << "\nMatrix shape mismatch (* matrix multiplication): (" << lhs.row() << ", " << lhs.col()
+                    << ") vs (" << rhs.row() << ", " << rhs.col() << ")";
+            throw ShapeMismatchException(message.str(), lhs.row(), lhs.col(), rhs.row(), rhs.col());
         }
 
-        tensor<type> result(_rows, _cols);
-        type temp;
-
-        for (int i = 0; i < _rows; ++i) {
-            for (int j = 0; j < _cols; ++j) {
-                temp = _tns[i][j] - rhs_tensor._tns[i][j];
-                result.updateMinMaxValues(temp);
-                result._tns[i][j] = temp;
-            }
+        // GEMM needs evenly spaced rows: a permutation interleaving the leading dimensions is copied first
+        if (!lhs.uniform()) {
+            const tensor<type> copy(lhs);
+            return matmul(copy.view(), rhs);
         }
-
-        return result;
-    }
-
-    template<typename type>
-    tensor<type> tensor<type>::operator/(const tensor<type> &rhs_tensor) const {
-        if (_rows != rhs_tensor._rows || _cols != rhs_tensor._cols) {
-            std::ostringstream message;
-            message << "\nMatrix shape mismatch (/ element-wise division): (" << _rows << ", " << _cols << ") vs ("
-                    << rhs_tensor._rows << ", " << rhs_tensor._cols << ")";
-            throw ShapeMismatchException(message.str(), _rows, _cols, rhs_tensor._rows, rhs_tensor._cols);
+        if (!rhs.uniform()) {
+            const tensor<type> copy(rhs);
+            return matmul(lhs, copy.view());
         }
 
-        tensor<type> result(_rows, _cols);
-        type temp;
+        tensor<type> result(lhs.row(), rhs.col());
 
-        for (int i = 0; i < _rows; ++i) {
-            for (int j = 0; j < _cols; ++j) {
-                temp = _tns[i][j] / rhs_tensor._tns[i][j];
-                result.updateMinMaxValues(temp);
-                result._tns[i][j] = temp;
-            }
-        }
+        // data() on result also invalidates its cached minimum and maximum
+        kernel::gemm<type>(lhs.row(), rhs.col(), lhs.col(), 1,
+                           lhs.data(), lhs.rowStride(), lhs.colStride(),
+                           rhs.data(), rhs.rowStride(), rhs.colStride(),
+                           0, result.data().data(), result.rowStride(), result.colStride());
 
         return result;
     }
 
-    // Scalar/Element-wise operators
-    template<typename type>
-    tensor<type> tensor<type>::operator+(const type &num) const {
-        return applyOperation(num, std::plus<type>());
-    }
-
-    template<typename type>
-    tensor<type> tensor<type>::operator-(const type &num) const {
-        return applyOperation(num, std::minus<type>());
-    }
+    template tensor<int> matmul<int>(const tensor_view<int> &, const tensor_view<int> &);
 
-    template<typename type>
-    tensor<type> tensor<type>::operator*(const type &num) const {
-        return applyOperation(num, std::multiplies<type>());
-    }
+    template tensor<double> matmul<double>(const tensor_view<double> &, const tensor_view<double> &);
 
-    template<typename type>
-    tensor<type> tensor<type>::operator/(const type &num) const {
-        return applyOperation(num, std::divides<type>());
-    }
+    template tensor<float> matmul<float>(const tensor_view<float> &, const tensor_view<float> &);
 
+// Output-parameter matrix multiplication
     template<typename type>
-    tensor<type> tensor<type>::operator^(const type &num) const {
-        auto powOperation = [](type a, type b) {
-            return std::pow(a, b);
-        };
-
-        return applyOperation(num, powOperation);
-    }
+    void gemm(const tensor<type> &lhs, const tensor<type> &rhs, tensor<type> &out, std::type_identity_t<type> alpha,
+              std::type_identity_t<type> beta) {
+        if (lhs.col() != rhs.row()) {
+            std::ostringstream message;
+            message << "\nMatrix shape mismatch (tns::gemm() matrix multiplication): (" << lhs.row() << ", "
+                    << lhs.col() << ") vs (" << rhs.row() << ", " << rhs.col() << ")";
+            throw ShapeMismatchException(message.str(), lhs.row(), lhs.col(), rhs.row(), rhs.col());
+        }
+        if (&out == &lhs || &out == &rhs) {
+            throw std::invalid_argument("\nOutput aliases an operand (tns::gemm()): out must not be lhs or rhs");
+        }
 
-// Private method
-    template<typename type>
-    tensor<type> tensor<type>::applyOperation(type num, std::function<type(type, type)> operation) const {
-        tensor<type> result(_rows, _cols);
-        result._minValue = _minValue;
-        result._maxValue = _maxValue;
-
-        for (int i = 0; i < _rows; ++i) {
-            for (int j = 0; j < _cols; ++j) {
-                result._tns[i][j] = operation(_tns[i][j], num);
-                result.updateMinMaxValues(result._tns[i][j]);
+        if (out.row() != lhs.row() || out.col() != rhs.col()) {
+            if (beta != type(0)) {
+                std::ostringstream message;
+                message << "\nMatrix shape mismatch (tns::gemm() output): (" << out.row() << ", " << out.col()
+                        << ") vs (" << lhs.row() << ", " << rhs.col() << ")";
+                throw ShapeMismatchException(message.str(), out.row(), out.col(), lhs.row(), rhs.col());
             }
+            out = tensor<type>(lhs.row(), rhs.col());
         }
 
-        return result;
+        // data() on out also invalidates its cached minimum and maximum
+        kernel::gemm<type>(lhs.row(), rhs.col(), lhs.col(), alpha,
+                           lhs.data().data(), lhs.rowStride(), lhs.colStride(),
+                           rhs.data().data(), rhs.rowStride(), rhs.colStride(),
+                           beta, out.data().data(), out.rowStride(), out.colStride());
     }
 
+    template void gemm<int>(const tensor<int> &, const tensor<int> &, tensor<int> &, int, int);
+
+    template void gemm<double>(const tensor<double> &, const tensor<double> &, tensor<double> &, double, double);
+
+    template void gemm<float>(const tensor<float> &, const tensor<float> &, tensor<float> &, float, float);
+
 } // tns
 
 template
@@ -56,6 +56,932 @@ void test_1() {
 
 }
 
+void test_2() {
+    tns::tensor<double> X(100, 100, -1, 1);
+    tns::tensor<double> Y;
+    tns::tensor<double> Z;
+
+    auto ReLU = [](double x) {
+        return (x > 0) ? x : 0;
+    };
+
+    Y = X.elementWise(ReLU);
+    const auto before = tns::storage::allocationStats();
+
+    for (int step = 0; step < 1000; ++step) {
+        Y = X.elementWise(ReLU);
+        Z = Y + X;
+        Y = Z.T();
+        Z = Y;
+    }
+
+    const auto after = tns::storage::allocationStats();
+
+    std::cout << "Live buffers before: " << before.live << ", after: " << after.live << std::endl;
+    std::cout << "Buffers allocated in the loop: " << after.allocations - before.allocations << std::endl;
+    std::cout << "Leak-free: " << (after.live == before.live ? GREEN : RED) << (after.live == before.live ? "yes" : "no")
+              << RESET << std::endl;
+}
+
+template<typename type>
+void benchGemm(size_t M, size_t K, size_t N) {
+    tns::tensor<type> A(M, K, -1, 1);
+    tns::tensor<type> B(K, N, -1, 1);
+    tns::tensor<type> C(M, N), D(M, N);
+    const double flop = 2.0 * M * N * K;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    tns::kernel::gemmNaive<type>(M, N, K, A.data().data(), K, 1, B.data().data(), N, 1, C.data().data(), N, 1);
+    auto end = std::chrono::high_resolution_clock::now();
+    const double naive = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    tns::kernel::gemm<type>(M, N, K, 1, A.data().data(), K, 1, B.data().data(), N, 1, 0, D.data().data(), N, 1);
+    end = std::chrono::high_resolution_clock::now();
+    const double blocked = std::chrono::duration<double>(end - start).count();
+
+    double maxError = 0;
+    for (size_t k = 0; k < M * N; ++k) {
+        maxError = std::max(maxError, static_cast<double>(std::abs(C.data()[k] - D.data()[k])));
+    }
+
+    std::cout << std::setw(6) << M << " x " << std::setw(5) << K << " x " << std::setw(5) << N
+              << " | naive: " << std::setw(8) << std::setprecision(3) << std::fixed << flop / naive * 1e-9
+              << " GFLOPS | blocked: " << YELLOW << std::setw(8) << flop / blocked * 1e-9 << RESET
+              << " GFLOPS | speed-up: " << std::setw(6) << naive / blocked
+              << "x | max error: " << std::scientific << maxError << std::defaultfloat << std::endl;
+}
+
+void test_3() {
+    std::cout << "Instruction set: " << tns::simd::isaName(tns::simd::active())
+              << " (detected " << tns::simd::isaName(tns::simd::detected()) << ")" << std::endl;
+    for (size_t n: {256, 512, 1024, 2048, 4096}) {
+        benchGemm<double>(n, n, n);
+    }
+    hRule(20);
+    for (size_t n: {256, 512, 1024, 2048, 4096}) {
+        benchGemm<float>(n, n, n);
+    }
+    hRule(20);
+    // Tall-skinny: batches of MNIST-sized inputs through 784-wide layers
+    benchGemm<double>(4096, 784, 10);
+    benchGemm<double>(16384, 784, 100);
+    benchGemm<float>(65536, 784, 10);
+    benchGemm<int>(4096, 784, 10);
+}
+
+template<typename Body>
+double seconds(Body &&body) {
+    auto start = std::chrono::high_resolution_clock::now();
+    body();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+template<typename Function>
+void benchElementWise(const std::string &name, const tns::tensor<double> &X, Function func) {
+    tns::tensor<double> Y(X.row(), X.col());
+    const size_t n = X.size();
+
+    // The former applyOperation: one type-erased call per element
+    const std::function<double(double)> erased = func;
+    const double *in = X.data().data();
+    double *out = Y.data().data();
+    const double typeErased = seconds([&] {
+        for (size_t k = 0; k < n; ++k) {
+            out[k] = erased(in[k]);
+        }
+    });
+
+    const double expression = seconds([&] { Y = X.elementWise(func); });
+
+    Y = X;
+    const double inPlace = seconds([&] { Y.apply(func); });
+
+    std::cout << std::setw(8) << name << " | std::function: " << std::setw(8) << std::setprecision(2) << std::fixed
+              << typeErased * 1e3 << " ms | elementWise: " << YELLOW << std::setw(8) << expression * 1e3 << RESET
+              << " ms | apply: " << YELLOW << std::setw(8) << inPlace * 1e3 << RESET << " ms | speed-up: "
+              << std::setw(5) << typeErased / expression << "x" << std::defaultfloat << std::endl;
+}
+
+void test_4() {
+    tns::tensor<double> X(10'000'000, 1, -5, 5);
+
+    std::cout << "Threads: " << tns::parallel::threadCount() << std::endl;
+    benchElementWise("ReLU", X, [](double x) { return (x > 0) ? x : 0; });
+    benchElementWise("sigmoid", X, [](double x) { return 1 / (1 + std::exp(-x)); });
+}
+
+void test_5() {
+    // One dense layer trained with plain gradient descent, every buffer allocated before the loop. Large elementwise
+    // updates run on the pool, so its chunk dispatch is part of the loop too
+    tns::parallel::configure(8);
+    const size_t batch = 64;
+    tns::tensor<double> X(784, batch, 0, 1);
+    tns::tensor<double> XT = X.T();
+    tns::tensor<double> target(10, batch, 0, 1);
+    tns::tensor<double> ones(batch, 1, 1.0), onesRow(1, batch, 1.0);
+    tns::tensor<double> W(10, 784, -0.05, 0.05);
+    tns::tensor<double> b(10, 1, 0.0);
+    tns::tensor<double> Z(10, batch), error(10, batch), gradW(10, 784), gradB(10, 1);
+    const double learningRate = 1e-3;
+
+    auto ReLU = [](double x) {
+        return (x > 0) ? x : 0;
+    };
+
+    tns::tensor<double> A(1000, 1000, -1, 1), B(1000, 1000, -1, 1), C(1000, 1000);
+
+    auto step = [&] {
+        C = A + B;                                                  // Evaluated in place into C, on the pool
+        C += A;
+        C.apply(ReLU);
+        tns::gemm(b, onesRow, Z);                                   // Z = b broadcast over the batch
+        tns::gemm(W, X, Z, 1.0, 1.0);                               // Z += W X
+        Z.apply(ReLU);
+        tns::subtract(Z, target, error);                            // error = Z - target
+        tns::gemm(error, XT, gradW, 1.0 / batch);                   // gradW = error X^T / batch
+        tns::gemm(error, ones, gradB, 1.0 / batch);                 // gradB = mean of error over the batch
+        W -= learningRate * gradW;
+        b -= learningRate * gradB;
+    };
+
+    // The first step sizes the GEMM packing buffers of this thread and the queues of the pool
+    step();
+    const auto before = tns::storage::allocationStats();
+    const size_t heapBefore = heapAllocations.load();
+
+    for (int k = 0; k < 100; ++k) {
+        step();
+    }
+
+    const size_t heap = heapAllocations.load() - heapBefore;
+    const auto after = tns::storage::allocationStats();
+    tns::parallel::configure(0);
+
+    std::cout << "Buffers allocated in the loop: " << after.allocations - before.allocations << std::endl;
+    std::cout << "Heap allocations in the loop: " << heap << std::endl;
+    std::cout << "Allocation-free: " << (heap == 0 ? GREEN : RED) << (heap == 0 ? "yes" : "no") << RESET << std::endl;
+    assert(heap == 0);
+}
+
+// The former read_csv: one std::istringstream per line, std::stod and a pow-based rounding per cell
+tns::tensor<double> readCsvNaive(const std::string &filename, int MAX_ROWS, int MAX_COLS, int precision) {
+    std::ifstream file(filename);
+    tns::tensor<double> output(MAX_ROWS, MAX_COLS);
+    double *out = output.data().data();
+    std::string line, string_cell;
+    int numRows = 0;
+
+    while (numRows < MAX_ROWS && std::getline(file, line, '\n')) {
+        std::istringstream iss(line);
+        int numCols = 0;
+        while (numCols < MAX_COLS && std::getline(iss, string_cell, ',')) {
+            out[numRows * MAX_COLS + numCols++] = std::round(std::stod(string_cell) * std::pow(10, precision))
+                                                 / std::pow(10, precision);
+        }
+        ++numRows;
+    }
+
+    return output;
+}
+
+// The former display(): setw and a std::string color per element through std::cout
+void displayNaive(const tns::tensor<double> &X, int precision) {
+    const double minValue = X.min(), maxValue = X.max();
+    float delta = (maxValue - minValue > 0) ? (maxValue - minValue) / 7.0 : 1;
+    const int padding = 4 - (minValue > 0);
+    const double digits = std::log10(std::max(std::max(std::abs(maxValue), std::abs(minValue)), 1.0)) + 1;
+    const int width = static_cast<int>(digits + padding + precision);
+
+    std::cout << std::setprecision(precision) << std::fixed;
+    for (size_t i = 0; i < X.row(); ++i) {
+        for (size_t j = 0; j < X.col(); ++j) {
+            std::cout << color::getColorConstant(round((X(i, j) - minValue) / (delta)));
+            std::cout << std::setw(width) << X(i, j) << color::RESET;
+        }
+        std::cout << '\n';
+    }
+    std::cout << std::setw(0) << std::setfill(' ') << std::setprecision(6);
+}
+
+// Text without its escape sequences
+std::string stripColors(const std::string &text) {
+    std::string plain;
+    for (size_t k = 0; k < text.size(); ++k) {
+        if (text[k] == '\033') {
+            k = text.find('m', k);
+        } else {
+            plain += text[k];
+        }
+    }
+    return plain;
+}
+
+void test_6() {
+    // CSVFile/test.csv repeated until the file reaches the requested size
+    const std::filesystem::path source = std::filesystem::path(__FILE__).parent_path() / "CSVFile" / "test.csv";
+    const std::filesystem::path scaled = std::filesystem::temp_directory_path() / "tns_read_csv_bench.csv";
+
+    std::ifstream in(source);
+    const std::string block((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const auto blockRows = static_cast<size_t>(std::count(block.begin(), block.end(), '\n'));
+
+    for (size_t megabytes: {64, 512, 2048}) {
+        const size_t copies = megabytes * 1'000'000 / block.size() + 1;
+        {
+            std::ofstream out(scaled, std::ios::binary);
+            for (size_t k = 0; k < copies; ++k) {
+                out << block;
+            }
+        }
+        const auto rows = static_cast<int>(copies * blockRows);
+
+        tns::tensor<double> X, Y;
+        tns::io::csv_stats stats;
+        const double naive = seconds([&] { X = readCsvNaive(scaled.string(), rows, 10, 5); });
+        const double mapped = seconds([&] { Y = tns::tensor<double>::read_csv(scaled.string(), rows, 10, 5, &stats); });
+
+        double maxError = 0;
+        for (size_t k = 0; k < X.size(); ++k) {
+            maxError = std::max(maxError, std::abs(X.data()[k] - Y.data()[k]));
+        }
+
+        std::cout << stats
+                  << "  getline + stod: " << std::setw(9) << std::setprecision(1) << std::fixed << naive * 1e3
+                  << " ms | " << std::setw(9) << stats.mbPerSecond(naive) << " MB/s | speed-up: " << YELLOW
+                  << naive / mapped << "x" << RESET << " | max error: " << std::scientific << maxError
+                  << std::defaultfloat << std::endl;
+        hRule(20);
+    }
+
+    std::filesystem::remove(scaled);
+}
+
+void test_7() {
+    // 512 MB of CSVFile/test.csv streamed in batches of 256 rows
+    const std::filesystem::path source = std::filesystem::path(__FILE__).parent_path() / "CSVFile" / "test.csv";
+    const std::filesystem::path scaled = std::filesystem::temp_directory_path() / "tns_batch_bench.csv";
+
+    std::ifstream in(source);
+    const std::string block((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    {
+        std::ofstream out(scaled, std::ios::binary);
+        for (size_t k = 0; k < 512'000'000 / block.size() + 1; ++k) {
+            out << block;
+        }
+    }
+
+    size_t rows = 0, batches = 0, peakBytes = 0;
+    double sum = 0;
+    const double elapsed = seconds([&] {
+        tns::io::csv_batch_reader<double> reader(scaled.string(), 256);
+        while (const tns::tensor<double> *batch = reader.next()) {
+            for (double value: batch->data()) {
+                sum += value;
+            }
+            rows += batch->row();
+            ++batches;
+            peakBytes = std::max(peakBytes, tns::storage::allocationStats().liveBytes);
+        }
+    });
+
+    const double megabytes = static_cast<double>(std::filesystem::file_size(scaled)) * 1e-6;
+    std::cout << std::fixed << std::setprecision(1) << megabytes << " MB, " << rows << " rows in " << batches
+              << " batches | " << elapsed * 1e3 << " ms | " << YELLOW << megabytes / elapsed << RESET << " MB/s"
+              << " | peak tensor memory: " << static_cast<double>(peakBytes) * 1e-3 << " kB | sum: " << sum
+              << std::defaultfloat << std::endl;
+
+    std::filesystem::remove(scaled);
+}
+
+void test_8() {
+    // The same 100000 x 784 doubles loaded from CSV, from a copied .npy and from a mapped .npy
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::string csv = (directory / "tns_npy_bench.csv").string(), npy = (directory / "tns_npy_bench.npy").string();
+
+    tns::tensor<double> X(100'000, 784, -1, 1);
+    {
+        std::ofstream out(csv);
+        out << std::setprecision(17);
+        for (size_t i = 0; i < X.row(); ++i) {
+            for (size_t j = 0; j < X.col(); ++j) {
+                out << X(i, j) << (j + 1 < X.col() ? ',' : '\n');
+            }
+        }
+    }
+    X.write_npy(npy);
+
+    tns::tensor<double> Y;
+    const double text = seconds([&] { Y = tns::tensor<double>::read_csv(csv); });
+    const double copied = seconds([&] { Y = tns::tensor<double>::read_npy(npy, false); });
+    const double mapped = seconds([&] { Y = tns::tensor<double>::read_npy(npy); });
+
+    std::cout << std::fixed << std::setprecision(2) << "read_csv: " << text * 1e3 << " ms | read_npy (copy): "
+              << copied * 1e3 << " ms | read_npy (mapped): " << YELLOW << mapped * 1e3 << RESET << " ms | mapped: "
+              << (Y.mapped() ? "yes" : "no") << " | first row sum: " << std::accumulate(Y.data().begin(),
+              Y.data().begin() + 784, 0.0) << std::defaultfloat << std::endl;
+
+    std::filesystem::remove(csv);
+    std::filesystem::remove(npy);
+}
+
+void test_9() {
+    // The layers of test_0() saved once, then loaded the way a restarting service would
+    const std::string model = (std::filesystem::temp_directory_path() / "tns_model.tnsw").string();
+    tns::tensor<double> w_0(10, 784, -0.5, 0.5), b_0(10, 1, -0.5, 0.5);
+    tns::tensor<double> w_1(4096, 4096, -0.5, 0.5), b_1(4096, 1, -0.5, 0.5);
+
+    const double save = seconds([&] {
+        tns::io::weight_writer writer(model);
+        writer.add("w_0", w_0);
+        writer.add("b_0", b_0);
+        writer.add("w_1", w_1);
+        writer.add("b_1", b_1);
+        writer.close();
+    });
+
+    tns::tensor<double> W_1;
+    const double load = seconds([&] {
+        tns::io::weight_file weights(model);
+        W_1 = weights.get<double>("w_1");
+    });
+    const double verify = seconds([&] { tns::io::weight_file weights(model, true); });
+
+    std::cout << std::fixed << std::setprecision(2) << std::filesystem::file_size(model) * 1e-6 << " MB | save: "
+              << save * 1e3 << " ms | load: " << YELLOW << load * 1e3 << RESET << " ms | load + verify: "
+              << verify * 1e3 << " ms | mapped: " << (W_1.mapped() ? "yes" : "no") << " | w_1(7, 7) matches: "
+              << (W_1(7, 7) == w_1(7, 7) ? "yes" : "no") << std::defaultfloat << std::endl;
+
+    std::filesystem::remove(model);
+}
+
+void test_10() {
+    // MNIST-shaped training set (60000 x 28 x 28 random pixels and 10 classes), as IDX and as CSV
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::string images = (directory / "tns-images-idx3-ubyte").string();
+    const std::string labels = (directory / "tns-labels-idx1-ubyte").string();
+    const std::string csv = (directory / "tns-images.csv").string();
+    const size_t count = 60'000, pixels = 784;
+
+    std::mt19937 gen(42);
+    std::vector<unsigned char> data(count * pixels), classes(count);
+    std::generate(data.begin(), data.end(), [&] { return static_cast<unsigned char>(gen()); });
+    std::generate(classes.begin(), classes.end(), [&] { return static_cast<unsigned char>(gen() % 10); });
+    {
+        const unsigned char imageHeader[16] = {0, 0, 0x08, 3, 0, 0, 0xEA, 0x60, 0, 0, 0, 28, 0, 0, 0, 28};
+        const unsigned char labelHeader[8] = {0, 0, 0x08, 1, 0, 0, 0xEA, 0x60};
+        std::ofstream(images, std::ios::binary).write(reinterpret_cast<const char *>(imageHeader), 16)
+                .write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        std::ofstream(labels, std::ios::binary).write(reinterpret_cast<const char *>(labelHeader), 8)
+                .write(reinterpret_cast<const char *>(classes.data()), static_cast<std::streamsize>(count));
+
+        std::ofstream out(csv);
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t j = 0; j < pixels; ++j) {
+                out << int(data[i * pixels + j]) << (j + 1 < pixels ? ',' : '\n');
+            }
+        }
+    }
+
+    const float scale = 1.0f / 255 / 0.3081f, shift = -0.1307f / 0.3081f;
+    tns::tensor<float> X, Y;
+
+    const double text = seconds([&] {
+        X = tns::tensor<float>::read_csv(csv);
+        X.apply([=](float x) { return x * scale + shift; });
+    });
+    const double whole = seconds([&] { Y = tns::io::idx_file(images).batch<float>(0, count, scale, shift); });
+
+    double maxError = 0;
+    for (size_t k = 0; k < X.size(); ++k) {
+        maxError = std::max(maxError, static_cast<double>(std::abs(X.data()[k] - Y.data()[k])));
+    }
+
+    double checksum = 0;
+    const double batched = seconds([&] {
+        tns::io::idx_file imageFile(images), labelFile(labels);
+        for (size_t first = 0; first < count; first += 64) {
+            const tns::tensor<float> batch = imageFile.batch<float>(first, 64, scale, shift);
+            const tns::tensor<float> target = labelFile.oneHot<float>(first, 64, 10);
+            checksum += batch.data()[0] + target.data()[0];
+        }
+    });
+
+    const double megabytes = count * pixels * 1e-6;
+    std::cout << std::fixed << std::setprecision(1) << "CSV + normalize: " << text * 1e3 << " ms | IDX, one tensor: "
+              << YELLOW << whole * 1e3 << RESET << " ms (" << megabytes / whole << " MB/s of pixels) | IDX, 938 batches"
+              << " of 64 with one-hot labels: " << batched * 1e3 << " ms | max difference: " << std::scientific
+              << maxError << std::defaultfloat << std::endl;
+
+    std::filesystem::remove(images);
+    std::filesystem::remove(labels);
+    std::filesystem::remove(csv);
+}
+
+void test_11() {
+    // 512 MB of CSVFile/test.csv read twice with the cache on: the first call parses, the second maps the sidecar
+    const std::filesystem::path source = std::filesystem::path(__FILE__).parent_path() / "CSVFile" / "test.csv";
+    const std::filesystem::path scaled = std::filesystem::temp_directory_path() / "tns_cache_bench.csv";
+
+    std::ifstream in(source);
+    const std::string block((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    {
+        std::ofstream out(scaled, std::ios::binary);
+        for (size_t k = 0; k < 512'000'000 / block.size() + 1; ++k) {
+            out << block;
+        }
+    }
+
+    tns::io::csv_options options;
+    options.cache = true;
+    tns::tensor<double> X, Y;
+    const double parsed = seconds([&] { X = tns::tensor<double>::read_csv(scaled.string(), options); });
+    const double cached = seconds([&] { Y = tns::tensor<double>::read_csv(scaled.string(), options); });
+
+    std::cout << std::fixed << std::setprecision(2) << X.row() << " x " << X.col() << " | parse + write cache: "
+              << parsed * 1e3 << " ms | cached: " << YELLOW << cached * 1e3 << RESET << " ms | mapped: "
+              << (Y.mapped() ? "yes" : "no") << " | same values: "
+              << (std::equal(X.data().begin(), X.data().end(), Y.data().begin()) ? "yes" : "no")
+              << std::defaultfloat << std::endl;
+
+    std::filesystem::remove(tns::io::csvCachePath(scaled.string()));
+    std::filesystem::remove(scaled);
+}
+
+void test_12() {
+    // 4 M random doubles written with write_csv() and with an ofstream loop, then read back
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "tns_write_bench.csv";
+    const tns::tensor<double> X(4000, 1000, -1e3, 1e3);
+
+    const double baseline = seconds([&] {
+        std::ofstream out(path);
+        out << std::setprecision(17);
+        for (size_t i = 0; i < X.row(); ++i) {
+            for (size_t j = 0; j < X.col(); ++j) {
+                out << X(i, j) << (j + 1 < X.col() ? ',' : '\n');
+            }
+        }
+    });
+    const double baselineMB = std::filesystem::file_size(path) / 1e6;
+
+    const double written = seconds([&] { X.write_csv(path.string()); });
+    const double writtenMB = std::filesystem::file_size(path) / 1e6;
+    const tns::tensor<double> Y = tns::tensor<double>::read_csv(path.string());
+
+    std::cout << std::fixed << std::setprecision(2) << "ofstream: " << baselineMB / baseline << " MB/s ("
+              << baselineMB << " MB) | write_csv: " << YELLOW << writtenMB / written << RESET << " MB/s ("
+              << writtenMB << " MB) | round trip: "
+              << (std::equal(X.data().begin(), X.data().end(), Y.data().begin()) ? "exact" : "lossy")
+              << std::defaultfloat << std::endl;
+
+    std::filesystem::remove(path);
+}
+
+void test_13() {
+    // A 1000 x 1000 tensor printed by the former display() and the buffered one, into a string instead of the terminal
+    const tns::tensor<double> X(1000, 1000, -100, 100);
+    std::ostringstream naive, buffered;
+
+    std::streambuf *console = std::cout.rdbuf(naive.rdbuf());
+    const double naiveSeconds = seconds([&] { displayNaive(X, 2); });
+    std::cout.rdbuf(buffered.rdbuf());
+    const double bufferedSeconds = seconds([&] { X.display(2, true, X.size()); });
+    std::cout.rdbuf(console);
+    std::cout.unsetf(std::ios::fixed);
+
+    std::cout << std::fixed << std::setprecision(2) << "setw + getColorConstant: " << naiveSeconds * 1e3
+              << " ms | buffered: " << YELLOW << bufferedSeconds * 1e3 << RESET << " ms | same text: "
+              << (stripColors(naive.str()) == stripColors(buffered.str()) ? "yes" : "no") << std::defaultfloat
+              << std::endl;
+}
+
+void test_14() {
+    // A 50,000 x 1,000 tensor with a smooth pattern: summarized, then as a heatmap of block means and maxima
+    tns::tensor<float> X(50'000, 1'000);
+    float *x = X.data().data();
+    for (size_t i = 0; i < X.row(); ++i) {
+        for (size_t j = 0; j < X.col(); ++j) {
+            x[i * X.col() + j] = std::sin(i * 1e-4f) * std::cos(j * 5e-3f);
+        }
+    }
+    const float min = X.min(); // Fills the min/max cache outside the timings
+    static_cast<void>(min);
+
+    const double summarized = seconds([&] { X.display(); });
+    const double mean = seconds([&] { X.heatmap(); });
+    const double max = seconds([&] { X.heatmap(12, 60, tns::io::heatmap_mode::max); });
+
+    std::cout << std::fixed << std::setprecision(3) << "summarized: " << summarized * 1e3 << " ms | heatmap (mean): "
+              << YELLOW << mean * 1e3 << RESET << " ms | heatmap (max): " << YELLOW << max * 1e3 << RESET << " ms"
+              << std::defaultfloat << std::endl;
+}
+
+void test_15() {
+    // Feature columns of a 200,000 x 32 table standardized one by one: copied first, or read through views
+    tns::tensor<double> X(200'000, 32, -1.0, 1.0);
+    tns::tensor<double> Z(200'000, 1);
+
+    const auto beforeCopy = tns::storage::allocationStats();
+    const double copied = seconds([&] {
+        for (size_t j = 0; j < X.col(); ++j) {
+            const tns::tensor<double> column = X[j]; // What X[j] returned before views
+            Z = (column - 0.5) * 2.0;
+        }
+    });
+    const auto afterCopy = tns::storage::allocationStats();
+    const double viewed = seconds([&] {
+        for (size_t j = 0; j < X.col(); ++j) {
+            Z = (X[j] - 0.5) * 2.0;
+        }
+    });
+    const auto afterView = tns::storage::allocationStats();
+
+    // Gram matrix X^T X with the transpose materialized, then read through its strides
+    tns::tensor<double> gramCopy, gramView;
+    const double transposeCopied = seconds([&] {
+        const tns::tensor<double> XT = X.T();
+        gramCopy = XT * X;
+    });
+    const double transposeViewed = seconds([&] { gramView = X.T() * X; });
+
+    double error = 0;
+    for (size_t k = 0; k < gramCopy.size(); ++k) {
+        error = std::max(error, std::abs(gramCopy.data()[k] - gramView.data()[k]));
+    }
+
+    std::cout << std::fixed << std::setprecision(2) << "columns copied: " << copied * 1e3 << " ms ("
+              << afterCopy.allocations - beforeCopy.allocations << " buffers) | viewed: " << YELLOW << viewed * 1e3
+              << RESET << " ms (" << afterView.allocations - afterCopy.allocations << " buffers)" << std::endl;
+    std::cout << "X^T X copied: " << transposeCopied * 1e3 << " ms | viewed: " << YELLOW << transposeViewed * 1e3
+              << RESET << " ms | max error: " << std::scientific << error << std::defaultfloat << std::endl;
+}
+
+void test_16() {
+    // A batch of 20,000 RGB 32 x 32 images, loaded flat as (20,000 x 3072) and given its N x C x H x W shape
+    tns::tensor<float> batch(20'000, 3 * 32 * 32, 0.0f, 1.0f);
+    const float *before = batch.data().data();
+    const auto beforeReshape = tns::storage::allocationStats();
+    batch.reshape({tns::tensor_shape::infer, 3, 32, 32});
+    const auto afterReshape = tns::storage::allocationStats();
+    std::cout << "reshaped to " << batch.shape() << ": " << afterReshape.allocations - beforeReshape.allocations
+              << " buffers, same elements: " << (batch.data().data() == before ? GREEN : RED)
+              << (batch.data().data() == before ? "yes" : "no") << RESET << std::endl;
+
+    // Element-wise arithmetic runs on the flat buffer whatever the rank
+    tns::tensor<float> flat(20'000, 3 * 32 * 32, 0.0f, 1.0f), outFlat, out4d;
+    const double flatTime = seconds([&] {
+        for (int run = 0; run < 10; ++run) outFlat = (flat - 0.5f) * 2.0f;
+    });
+    const double rank4Time = seconds([&] {
+        for (int run = 0; run < 10; ++run) out4d = (batch - 0.5f) * 2.0f;
+    });
+    std::cout << std::fixed << std::setprecision(2) << "(x - 0.5) * 2 x10, 2-D: " << flatTime * 1e3
+              << " ms | 4-D: " << YELLOW << rank4Time * 1e3 << RESET << " ms, result " << out4d.shape() << std::endl;
+
+    // NCHW -> NHWC: index arithmetic per element, or a permuted view copied with collapsed dimensions
+    const size_t N = 20'000, C = 3, H = 32, W = 32;
+    tns::tensor<float> naive(tns::tensor_shape{N, H, W, C});
+    const double naiveTime = seconds([&] {
+        const float *in = batch.data().data();
+        float *out = naive.data().data();
+        for (size_t n = 0; n < N; ++n)
+            for (size_t h = 0; h < H; ++h)
+                for (size_t w = 0; w < W; ++w)
+                    for (size_t c = 0; c < C; ++c)
+                        out[((n * H + h) * W + w) * C + c] = in[((n * C + c) * H + h) * W + w];
+    });
+    tns::tensor<float> nhwc(naive.shape());
+    const double permuteTime = seconds([&] { nhwc = batch.permute({0, 2, 3, 1}); });
+    const bool same = std::equal(naive.data().begin(), naive.data().end(), nhwc.data().begin());
+    std::cout << "NCHW -> NHWC naive: " << naiveTime * 1e3 << " ms | permute: " << YELLOW << permuteTime * 1e3
+              << RESET << " ms, " << nhwc.shape() << ", identical: " << (same ? GREEN : RED) << (same ? "yes" : "no")
+              << RESET << std::defaultfloat << std::endl;
+
+    // Per-channel blocks, unsqueeze / squeeze, and shape checks
+    const tns::tensor<float> channels = batch.permute({1, 0, 2, 3}).eval().reshape({C, tns::tensor_shape::infer});
+    batch.unsqueeze(0);
+    std::cout << "channel blocks " << channels.shape() << ", unsqueezed " << batch.shape();
+    batch.squeeze();
+    std::cout << ", squeezed " << batch.shape() << std::endl;
+    try {
+        out4d = batch + flat;
+    } catch (const tns::ShapeMismatchException &error) {
+        std::cout << "rejected:" << error.what() << std::endl;
+    }
+}
+
+void test_17() {
+    // Bias of a dense layer: (256 x 784) weights times a batch of 512 columns, plus a (256 x 1) bias per feature
+    tns::tensor<float> w(256, 784, -0.5f, 0.5f), x(784, 512, 0.0f, 1.0f), b(256, 1, -0.5f, 0.5f);
+    const tns::tensor<float> product = w * x;
+    tns::tensor<float> tiled, broadcast;
+
+    const double tiledTime = seconds([&] {
+        for (int run = 0; run < 50; ++run) {
+            tns::tensor<float> bias(product.row(), product.col()); // What adding a bias took before broadcasting
+            for (size_t i = 0; i < bias.row(); ++i) {
+                std::fill_n(bias.data().data() + i * bias.col(), bias.col(), b(i, 0));
+            }
+            tiled = product + bias;
+        }
+    });
+    const auto before = tns::storage::allocationStats();
+    const double broadcastTime = seconds([&] {
+        for (int run = 0; run < 50; ++run) broadcast = product + b;
+    });
+    const auto after = tns::storage::allocationStats();
+    const bool same = std::equal(tiled.data().begin(), tiled.data().end(), broadcast.data().begin());
+
+    std::cout << std::fixed << std::setprecision(2) << "column bias (256 x 512) x50, tiled: " << tiledTime * 1e3
+              << " ms | broadcast: " << YELLOW << broadcastTime * 1e3 << RESET << " ms ("
+              << after.allocations - before.allocations << " buffers), identical: " << (same ? GREEN : RED)
+              << (same ? "yes" : "no") << RESET << std::endl;
+
+    // Per-feature scaling of 200,000 samples of 64 features by a (1 x 64) row
+    tns::tensor<float> X(200'000, 64, 0.0f, 1.0f), mean(1, 64, 0.5f), scale(1, 64, 2.0f), Z(200'000, 64);
+    const double loopTime = seconds([&] {
+        for (size_t i = 0; i < X.row(); ++i) {
+            for (size_t j = 0; j < X.col(); ++j) {
+                Z.data()[i * X.col() + j] = (X(i, j) - mean(0, j)) * scale(0, j);
+            }
+        }
+    });
+    tns::tensor<float> Zb(200'000, 64);
+    const double rowTime = seconds([&] { Zb = (X - mean).multiply(scale); });
+    float error = 0;
+    for (size_t k = 0; k < Z.size(); ++k) {
+        error = std::max(error, std::abs(Z.data()[k] - Zb.data()[k]));
+    }
+    std::cout << "row scaling (200,000 x 64), loop: " << loopTime * 1e3 << " ms | broadcast: " << YELLOW
+              << rowTime * 1e3 << RESET << " ms | max error: " << std::scientific << error << std::defaultfloat
+              << std::endl;
+}
+
+void test_18() {
+    // Chain of 3x3 transforms applied to a point, and their determinant, as model code does per sample
+    constexpr int runs = 200'000;
+    const double c = std::cos(0.01), s = std::sin(0.01);
+    const tns::fixed_tensor<double, 3, 3> rotation{c, -s, 0.0, s, c, 0.0, 0.0, 0.0, 1.0};
+    const tns::fixed_tensor<double, 3, 3> shift{1.0, 0.0, 0.5, 0.0, 1.0, -0.5, 0.0, 0.0, 1.0};
+    const tns::tensor<double> rotationDynamic = rotation.toTensor(), shiftDynamic = shift.toTensor();
+
+    double dynamicSum = 0, fixedSum = 0;
+    const auto before = tns::storage::allocationStats();
+    const double dynamicTime = seconds([&] {
+        tns::tensor<double> transform = tns::fixed_tensor<double, 3, 3>::identity().toTensor();
+        for (int run = 0; run < runs; ++run) {
+            transform = rotationDynamic * (shiftDynamic * transform);
+            dynamicSum += transform.det() + transform(0, 2);
+        }
+    });
+    const auto middle = tns::storage::allocationStats();
+    const double fixedTime = seconds([&] {
+        auto transform = tns::fixed_tensor<double, 3, 3>::identity();
+        for (int run = 0; run < runs; ++run) {
+            transform = rotation * (shift * transform);
+            fixedSum += transform.det() + transform(0, 2);
+        }
+    });
+    const auto after = tns::storage::allocationStats();
+
+    std::cout << std::fixed << std::setprecision(2) << "3x3 transform chain x" << runs << ", tensor: "
+              << dynamicTime * 1e3 << " ms (" << middle.allocations - before.allocations << " buffers) | fixed_tensor: "
+              << YELLOW << fixedTime * 1e3 << RESET << " ms (" << after.allocations - middle.allocations
+              << " buffers), difference: " << std::scientific << std::abs(dynamicSum - fixedSum) << std::defaultfloat
+              << std::endl;
+
+    // Dense head: (10 x 64) weights times a 64-feature sample, plus a bias
+    tns::fixed_tensor<float, 10, 64> w;
+    tns::fixed_tensor<float, 64, 1> x;
+    tns::fixed_tensor<float, 10, 1> b(0.1f), y;
+    for (size_t k = 0; k < w.size(); ++k) w.data()[k] = static_cast<float>(k % 7) * 0.01f;
+    for (size_t k = 0; k < x.size(); ++k) x.data()[k] = static_cast<float>(k % 5) * 0.1f;
+    const tns::tensor<float> wDynamic = w.toTensor(), xDynamic = x.toTensor(), bDynamic = b.toTensor();
+    tns::tensor<float> yDynamic;
+
+    const double headDynamicTime = seconds([&] {
+        for (int run = 0; run < runs; ++run) yDynamic = wDynamic * xDynamic + bDynamic;
+    });
+    const double headFixedTime = seconds([&] {
+        for (int run = 0; run < runs; ++run) y = w * x + b;
+    });
+    const tns::fixed_tensor<float, 10, 1> difference = tns::fixed_tensor<float, 10, 1>(yDynamic) - y;
+    float error = 0;
+    for (float d : difference.data()) error = std::max(error, std::abs(d));
+    std::cout << "dense head (10 x 64) x" << runs << ", tensor: " << std::fixed << headDynamicTime * 1e3
+              << " ms | fixed_tensor: " << YELLOW << headFixedTime * 1e3 << RESET << " ms | max error: "
+              << std::scientific << error << std::defaultfloat << std::endl;
+}
+
+void test_19() {
+    // Tiny-tensor churn: 3x3 temporaries created, copied, combined and moved, like subTensor(), minor() and small
+    // model code do in a loop
+    constexpr int runs = 200'000;
+    tns::tensor<double> A(4, 4, -1.0, 1.0);
+    const tns::tensor<double> B(3, 3, -1.0, 1.0);
+    std::vector<tns::tensor<double>> kept(16);
+    double checksum = 0;
+
+    const auto before = tns::storage::allocationStats();
+    const double churnTime = seconds([&] {
+        for (int run = 0; run < runs; ++run) {
+            tns::tensor<double> sub = A.subTensor(run % 4, (run / 4) % 4);
+            const tns::tensor<double> copy = sub;
+            tns::tensor<double> combined = copy + B * 0.5;
+            kept[run % kept.size()] = std::move(combined);
+            checksum += kept[run % kept.size()](1, 1) + sub.det();
+        }
+    });
+    const auto after = tns::storage::allocationStats();
+
+    std::cout << std::fixed << std::setprecision(2) << "tiny-tensor churn (3x3) x" << runs << ": " << YELLOW
+              << churnTime * 1e3 << RESET << " ms, " << after.allocations - before.allocations
+              << " buffers (inline up to " << tns::storage::SMALL_SIZE << " elements, sizeof(tensor<double>) = "
+              << sizeof(tns::tensor<double>) << "), checksum " << checksum << std::defaultfloat << std::endl;
+}
+
+void test_20() {
+    // A 2,000,000-line CSV whose only malformed line is near the end, parsed by 8 threads: the error names that line
+    // on every run, the line skipBadLines reports
+    const std::string path = (std::filesystem::temp_directory_path() / "tns_bad_line.csv").string();
+    constexpr size_t lines = 2'000'000, badLine = 1'999'996;
+    {
+        std::ofstream out(path);
+        for (size_t line = 1; line <= lines; ++line) {
+            if (line == badLine) {
+                out << line << ",1\n";
+            } else {
+                out << line << ",1,2\n";
+            }
+        }
+    }
+    tns::parallel::configure(8);
+
+    tns::io::csv_options skip;
+    skip.skipBadLines = true;
+    tns::io::csv_report report;
+    tns::tensor<double>::read_csv(path, skip, &report);
+    const std::string expected = "line " + std::to_string(report.skipped.at(0).line) + ":";
+
+    bool correct = report.skipped.size() == 1 && report.skipped[0].line == badLine;
+    for (int run = 0; run < 5; ++run) {
+        try {
+            tns::tensor<double>::read_csv(path);
+            correct = false;
+        } catch (const std::invalid_argument &error) {
+            const std::string message = error.what();
+            correct = correct && message.find(expected) != std::string::npos;
+            std::cout << "run " << run << ":" << message << std::endl;
+        }
+    }
+    std::cout << "bad line " << badLine << " reported on every run: " << (correct ? GREEN : RED)
+              << (correct ? "yes" : "no") << RESET << std::endl;
+
+    tns::parallel::configure(0);
+    std::filesystem::remove(path);
+}
+
+void test_21() {
+    // A writer abandoned by an exception leaves the previous model in place, and no temporary file
+    const std::string model = (std::filesystem::temp_directory_path() / "tns_abandoned.tnsw").string();
+    const tns::tensor<double> w(64, 32, -1.0, 1.0), b(64, 1, 0.5);
+    {
+        tns::io::weight_writer writer(model);
+        writer.add("w", w);
+        writer.add("b", b);
+        writer.close();
+    }
+
+    bool thrown = false;
+    try {
+        tns::io::weight_writer writer(model);
+        writer.add("w", b);
+        writer.add("w", w); // Duplicate name: throws before close()
+        writer.close();
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+
+    const tns::io::weight_file file(model, true);
+    const tns::tensor<double> loaded = file.get<double>("w");
+    const bool kept = thrown && file.entries().size() == 2 && loaded.row() == 64 && loaded.col() == 32
+                      && std::equal(w.data().begin(), w.data().end(), loaded.data().begin());
+    const bool clean = !std::filesystem::exists(model + ".tmp");
+    std::cout << "previous model kept: " << (kept ? GREEN : RED) << (kept ? "yes" : "no") << RESET
+              << " | temporary file removed: " << (clean ? GREEN : RED) << (clean ? "yes" : "no") << RESET
+              << std::endl;
+
+    std::filesystem::remove(model);
+}
+
+void test_22() {
+    // N-dimensional tensors keep their shape through a weight file, borrowed or converted
+    const std::string model = (std::filesystem::temp_directory_path() / "tns_shapes.tnsw").string();
+    tns::tensor<double> kernels(tns::tensor_shape{8, 3, 5, 5}), bias(tns::tensor_shape{8}), scale(tns::tensor_shape{});
+    for (size_t k = 0; k < kernels.size(); ++k) kernels.data()[k] = static_cast<double>(k) - 300.0;
+    bias.data()[7] = 2.5;
+    scale.data()[0] = 0.1;
+    {
+        tns::io::weight_writer writer(model);
+        writer.add("kernels", kernels);
+        writer.add("bias", bias);
+        writer.add("scale", scale);
+        writer.close();
+    }
+
+    const tns::io::weight_file file(model, true);
+    const tns::tensor<double> kernelsBack = file.get<double>("kernels"), biasBack = file.get<double>("bias");
+    const tns::tensor<double> scaleBack = file.get<double>("scale");
+    const tns::tensor<int> kernelsConverted = file.get<int>("kernels");
+    const bool shapes = kernelsBack.shape() == kernels.shape() && biasBack.shape() == bias.shape()
+                        && scaleBack.shape() == scale.shape() && kernelsConverted.shape() == kernels.shape()
+                        && file.entries()[0].shape == kernels.shape();
+    const bool values = std::equal(kernels.data().begin(), kernels.data().end(), kernelsBack.data().begin())
+                        && biasBack.data()[7] == 2.5 && scaleBack.data()[0] == 0.1
+                        && kernelsConverted.data()[599] == 299;
+    std::cout << "kernels " << kernelsBack.shape() << ", bias " << biasBack.shape() << ", scale " << scaleBack.shape()
+              << " | shapes kept: " << (shapes ? GREEN : RED) << (shapes ? "yes" : "no") << RESET
+              << " | values kept: " << (values ? GREEN : RED) << (values ? "yes" : "no") << RESET << std::endl;
+
+    std::filesystem::remove(model);
+}
+
+void test_23() {
+    // Assigning to a tensor mapped from a .npy file gives it its own elements, the file is left as it was
+    const std::string npy = (std::filesystem::temp_directory_path() / "tns_assign.npy").string();
+    const tns::tensor<double> saved(100, 50, 1.0), replacement(100, 50, 2.0);
+    saved.write_npy(npy);
+
+    tns::tensor<double> copied = tns::tensor<double>::read_npy(npy), evaluated = tns::tensor<double>::read_npy(npy);
+    const bool mappedBefore = copied.mapped() && evaluated.mapped();
+    copied = replacement;
+    evaluated = replacement * 3.0;
+
+    const tns::tensor<double> reread = tns::tensor<double>::read_npy(npy, false);
+    const bool owned = mappedBefore && !copied.mapped() && !evaluated.mapped() && copied(99, 49) == 2.0
+                       && evaluated(99, 49) == 6.0;
+    const bool unchanged = std::all_of(reread.data().begin(), reread.data().end(), [](double x) { return x == 1.0; });
+    std::cout << "assigned tensors own their elements: " << (owned ? GREEN : RED) << (owned ? "yes" : "no") << RESET
+              << " | file unchanged: " << (unchanged ? GREEN : RED) << (unchanged ? "yes" : "no") << RESET
+              << std::endl;
+
+    std::filesystem::remove(npy);
+}
+
+void test_24() {
+    // Threads sharing a const tensor read its lazily computed minimum and maximum, or copy it, at the same time: every
+    // thread sees the values of a single refresh
+    const tns::tensor<double> shared(256, 256, -1.0, 1.0);
+    const double expectedMin = *std::min_element(shared.data().begin(), shared.data().end());
+    const double expectedMax = *std::max_element(shared.data().begin(), shared.data().end());
+
+    std::vector<int> agree(4, 0);
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < agree.size(); ++t) {
+        readers.emplace_back([&, t] {
+            if (t % 2 == 0) {
+                agree[t] = shared.min() == expectedMin && shared.max() == expectedMax;
+            } else {
+                const tns::tensor<double> copy(shared);
+                agree[t] = copy.min() == expectedMin && copy.max() == expectedMax;
+            }
+        });
+    }
+    for (std::thread &reader: readers) {
+        reader.join();
+    }
+
+    const bool consistent = std::all_of(agree.begin(), agree.end(), [](int ok) { return ok == 1; });
+    std::cout << "concurrent min and max agree: " << (consistent ? GREEN : RED) << (consistent ? "yes" : "no")
+              << RESET << std::endl;
+
+    // Pool chunks read the minimum of a large tensor, whose own reduction runs on the pool: a thread waiting for its
+    // reduction chunks executes outer chunks that read the same minimum
+    tns::parallel::configure(8);
+    tns::tensor<double> large(2048, 2048, -1.0, 1.0);
+    const tns::tensor<double> &nested = large;
+    const double nestedMin = *std::min_element(nested.data().begin(), nested.data().end());
+    const double nestedMax = *std::max_element(nested.data().begin(), nested.data().end());
+
+    bool nestedConsistent = true;
+    for (int round = 0; round < 10; ++round) {
+        std::vector<int> nestedAgree(256, 0);
+        (void) large.data(); // Marks the cache stale
+        tns::parallel::parallelFor(0, nestedAgree.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                nestedAgree[i] = nested.min() == nestedMin && nested.max() == nestedMax;
+            }
+        });
+        nestedConsistent = nestedConsistent && std::all_of(nestedAgree.begin(), nestedAgree.end(),
+                                                            [](int ok) { return ok == 1; });
+    }
+    tns::parallel::configure(0);
+
+    std::cout << "min and max inside pool chunks agree: " << (nestedConsistent ? GREEN : RED)
+              << (nestedConsistent ? "yes" : "no") << RESET << std::endl;
+}
+
 int main() {
     std::cout << GREEN << "Starting the program!" << RESET << std::endl;
     std::cout << MAGENTA << "---------------------------" << RESET << std::endl;
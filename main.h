@@ -10,13 +10,62 @@
 #include <sstream>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <numeric>
+#include <random>
+#include <thread>
 
 #include "Color/color.h"
 #include "Tensor/tensor.h"
+#include "Tensor/Fixed/fixed_tensor.h"
+#include "Tensor/IO/csv_cache.h"
+#include "Tensor/IO/csv_stream.h"
+#include "Tensor/IO/idx.h"
+#include "Tensor/IO/weights.h"
+#include "Tensor/Kernel/gemm.h"
+#include "Tensor/Kernel/simd.h"
+#include "Tensor/Parallel/thread_pool.h"
 
 using namespace color;
 
+// Every heap allocation of the program (tensor buffers, std::function, containers...), for the tests that check a
+// loop allocates nothing at all
+std::atomic<size_t> heapAllocations{0};
+
+void *operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(std::max<size_t>(size, 1))) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<size_t>(alignment);
+    if (void *memory = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+// Not inlined, so the compiler never pairs a new-expression with std::free
+[[gnu::noinline]] void operator delete(void *memory) noexcept { std::free(memory); }
+
+[[gnu::noinline]] void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+
+[[gnu::noinline]] void operator delete(void *memory, std::align_val_t) noexcept { std::free(memory); }
+
+[[gnu::noinline]] void operator delete(void *memory, size_t, std::align_val_t) noexcept { std::free(memory); }
+
 double executeTime(void (*func)(), bool secondUnit = false) {
     auto start = std::chrono::high_resolution_clock::now();
 